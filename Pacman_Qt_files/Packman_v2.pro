@@ -1,4 +1,4 @@
-QT       += core gui multimedia network
+QT       += core gui multimedia network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,11 +9,48 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    assetmanager.cpp \
+    batchsimulator.cpp \
+    clusterpaths.cpp \
+    gamecore.cpp \
     gamewidget.cpp \
-    main.cpp
+    ghostpool.cpp \
+    main.cpp \
+    mazebits.cpp \
+    mazelayer.cpp \
+    pathtable.cpp \
+    pixelframe.cpp \
+    profiler.cpp \
+    scaledpixmap.cpp \
+    sessionlog.cpp \
+    simulationthread.cpp \
+    spriteatlas.cpp \
+    tickscheduler.cpp \
+    tileindex.cpp \
+    tilerenderer.cpp
 
 HEADERS += \
-    gamewidget.h
+    assetmanager.h \
+    batchsimulator.h \
+    clusterpaths.h \
+    gamecore.h \
+    gamerng.h \
+    gametypes.h \
+    gamewidget.h \
+    ghostpool.h \
+    mazebits.h \
+    mazelayer.h \
+    pathtable.h \
+    pixelframe.h \
+    profiler.h \
+    scaledpixmap.h \
+    sessionlog.h \
+    simulationthread.h \
+    spriteatlas.h \
+    tickscheduler.h \
+    tileindex.h \
+    tilerenderer.h \
+    triplebuffer.h
 
 FORMS +=
 
@@ -0,0 +1,71 @@
+#include "assetmanager.h"
+#include <QDebug>
+#include <QtConcurrent>
+
+AssetManager::AssetManager(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+}
+
+void AssetManager::request(const QString &path)
+{
+    if (m_entries.contains(path)) return;
+
+    Entry &entry = m_entries[path];
+    entry.watcher = new QFutureWatcher<Decoded>(this);
+    connect(entry.watcher, &QFutureWatcher<Decoded>::finished, this, [this, path]() { finish(path); });
+    entry.watcher->setFuture(QtConcurrent::run([path]() {
+        QElapsedTimer timer;
+        timer.start();
+        Decoded decoded;
+        decoded.image.load(path);
+        decoded.decodeMs = timer.elapsed();
+        return decoded;
+    }));
+    mark(QString("%1 requested").arg(path));
+}
+
+QPixmap AssetManager::pixmap(const QString &path)
+{
+    request(path);
+    return m_entries[path].pixmap;
+}
+
+QPixmap AssetManager::waitForPixmap(const QString &path)
+{
+    request(path);
+    Entry &entry = m_entries[path];
+    if (entry.watcher) {
+        entry.watcher->waitForFinished();
+        finish(path);
+    }
+    return entry.pixmap;
+}
+
+void AssetManager::mark(const QString &event)
+{
+    qDebug().noquote() << QString("[assets %1 ms]").arg(m_clock.elapsed(), 5) << event;
+}
+
+// Takes a decoded image over from its worker. Pixmaps may only be made on
+// the GUI thread, so the conversion happens here and not in the worker.
+void AssetManager::finish(const QString &path)
+{
+    Entry &entry = m_entries[path];
+    if (!entry.watcher) return; // Already taken over by waitForPixmap()
+
+    const Decoded decoded = entry.watcher->result();
+    entry.watcher->disconnect(this);
+    entry.watcher->deleteLater();
+    entry.watcher = nullptr;
+    entry.pixmap = QPixmap::fromImage(decoded.image);
+
+    if (entry.pixmap.isNull()) {
+        mark(QString("%1 could not be loaded").arg(path));
+    } else {
+        mark(QString("%1 ready, %2x%3 decoded in %4 ms").arg(path).arg(decoded.image.width())
+                 .arg(decoded.image.height()).arg(decoded.decodeMs));
+    }
+    emit ready(path);
+}
@@ -0,0 +1,57 @@
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QString>
+
+// Image assets, decoded on the global thread pool and kept once decoded.
+//
+// Nothing is decoded until it is request()ed, and a request returns at
+// once; ready() is emitted on the GUI thread when the asset is in. Every
+// request and decode goes into a timeline on the debug log, timed from
+// the manager's creation, so slow starts are easy to see.
+class AssetManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AssetManager(QObject *parent = nullptr);
+
+    // Starts decoding 'path' unless it is decoded or on its way
+    void request(const QString &path);
+
+    // The decoded asset, or a null pixmap (and a request) if not in yet
+    QPixmap pixmap(const QString &path);
+
+    // The decoded asset, waiting for the decode if need be
+    QPixmap waitForPixmap(const QString &path);
+
+    // Logs 'event' on the timeline
+    void mark(const QString &event);
+
+signals:
+    void ready(const QString &path);
+
+private:
+    struct Decoded {
+        QImage image;
+        qint64 decodeMs;
+    };
+
+    struct Entry {
+        QFutureWatcher<Decoded> *watcher; // Until decoded
+        QPixmap pixmap;
+    };
+
+    void finish(const QString &path);
+
+    QElapsedTimer m_clock;
+    QHash<QString, Entry> m_entries;
+};
+
+#endif // ASSETMANAGER_H
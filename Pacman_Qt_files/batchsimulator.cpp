@@ -0,0 +1,181 @@
+#include "batchsimulator.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+struct Job {
+    int round;
+    quint64 seed;
+};
+
+// Keeps heading the same way and picks a new random direction now and then
+Direction randomControllerInput(GameRng &rng, Direction current)
+{
+    if (current == Stop || rng.bounded(8) == 0) {
+        return static_cast<Direction>(rng.bounded(4));
+    }
+    return current;
+}
+
+// Walks the shortest path to the nearest remaining pellet, ignoring ghosts
+Direction greedyControllerInput(const GameCore &core, GameRng &rng, Direction current)
+{
+    if (core.isPacmanMoving()) {
+        return current;
+    }
+
+    static const int dCol[4] = { 0, 0, -1, 1 }; // Up, Down, Left, Right
+    static const int dRow[4] = { -1, 1, 0, 0 };
+
+    const int width = core.mazeWidth();
+    const int height = core.mazeHeight();
+    QPoint start = core.pacmanCell();
+    QVector<qint8> firstDir(width * height, -1);
+
+    QVector<QPoint> queue(width * height);
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    firstDir[start.y() * width + start.x()] = Stop;
+
+    while (head < tail) {
+        QPoint cur = queue[head++];
+        for (int d = 0; d < 4; ++d) {
+            int c = cur.x() + dCol[d];
+            int r = cur.y() + dRow[d];
+            if (c < 0 || c >= width || r < 0 || r >= height) continue;
+            if (core.cellAt(r, c) == 1 || firstDir[r * width + c] != -1) continue;
+
+            qint8 dir = (cur == start) ? d : firstDir[cur.y() * width + cur.x()];
+            firstDir[r * width + c] = dir;
+            int cell = core.cellAt(r, c);
+            if (cell == 0 || cell == 4) {
+                return static_cast<Direction>(dir);
+            }
+            queue[tail++] = QPoint(c, r);
+        }
+    }
+    return randomControllerInput(rng, current);
+}
+
+BatchSimulator::GameResult playGame(const GameCore &prototype, const BatchSimulator::Config &config,
+                                    const Job &job)
+{
+    BatchSimulator::GameResult result;
+    result.round = job.round;
+
+    GameCore core(prototype);
+    if (!core.startRound(job.round, true, job.seed)) {
+        return result;
+    }
+
+    // The controller gets its own stream so it never shifts the ghosts' draws
+    GameRng rng(~job.seed);
+    Direction input = Right;
+    while (core.status() == GameCore::Running && core.tick() < quint64(config.maxTicks)) {
+        if (config.controller == BatchSimulator::GreedyController) {
+            input = greedyControllerInput(core, rng, input);
+        } else {
+            input = randomControllerInput(rng, input);
+        }
+        core.step(input);
+    }
+
+    result.status = core.status();
+    result.ticks = int(core.tick());
+    result.pelletsEaten = core.pelletsEaten();
+    result.score = core.score();
+    result.caughtBy = core.caughtByType();
+    return result;
+}
+
+} // namespace
+
+BatchSimulator::BatchSimulator(const GameCore &prototype)
+    : m_prototype(prototype),
+    m_lastRunNs(0)
+{
+}
+
+QVector<BatchSimulator::RoundReport> BatchSimulator::run(const Config &config)
+{
+    m_pool.setMaxThreadCount(config.threads > 0 ? config.threads : QThread::idealThreadCount());
+
+    QVector<Job> jobs;
+    jobs.reserve((config.lastRound - config.firstRound + 1) * config.gamesPerRound);
+    for (int round = config.firstRound; round <= config.lastRound; ++round) {
+        for (int i = 0; i < config.gamesPerRound; ++i) {
+            // Every (round, game) pair gets its own reproducible seed
+            jobs.append({ round, (config.seed << 32) ^ (quint64(round) << 24) ^ quint64(i) });
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Idle pool threads keep pulling the next unplayed game, so long and
+    // short games balance out across cores without static partitioning.
+    const GameCore &prototype = m_prototype;
+    QVector<GameResult> results = QtConcurrent::blockingMapped<QVector<GameResult>>(
+        &m_pool, jobs, [&prototype, &config](const Job &job) {
+            return playGame(prototype, config, job);
+        });
+
+    m_lastRunNs = timer.nsecsElapsed();
+
+    QVector<RoundReport> reports;
+    for (int round = config.firstRound; round <= config.lastRound; ++round) {
+        RoundReport report;
+        report.round = round;
+
+        QVector<int> survival;
+        qint64 totalTicks = 0;
+        qint64 totalPellets = 0;
+        for (const GameResult &r : results) {
+            if (r.round != round) continue;
+            report.games++;
+            if (r.status == GameCore::Won) report.wins++;
+            else if (r.status == GameCore::Lost) report.losses++;
+            else report.timeouts++;
+            if (r.caughtBy >= 0) report.caughtBy[r.caughtBy]++;
+            survival.append(r.ticks);
+            totalTicks += r.ticks;
+            totalPellets += r.pelletsEaten;
+        }
+
+        if (report.games > 0) {
+            std::sort(survival.begin(), survival.end());
+            report.meanSurvivalTicks = double(totalTicks) / report.games;
+            report.medianSurvivalTicks = survival[survival.size() / 2];
+            report.p90SurvivalTicks = survival[(survival.size() * 9) / 10];
+            report.meanPelletsEaten = double(totalPellets) / report.games;
+        }
+        reports.append(report);
+    }
+    return reports;
+}
+
+void BatchSimulator::printReport(QTextStream &out, const QVector<RoundReport> &reports)
+{
+    static const char *typeNames[] = { "Original", "Chaser", "Ambusher", "Patrol", "Random" };
+
+    out << "Round  Games   Win%  Lose%   T/O%   Survival s (mean/p50/p90)  Pellets  Caught by" << Qt::endl;
+    for (const RoundReport &r : reports) {
+        if (r.games == 0) continue;
+        auto pct = [&r](int n) { return 100.0 * n / r.games; };
+        auto secs = [](double ticks) { return ticks * FRAMETIME / 1000.0; };
+
+        QString line = QString::asprintf("%5d  %5d  %5.1f  %5.1f  %5.1f   %7.1f /%7.1f /%7.1f   %7.1f ",
+                                         r.round, r.games, pct(r.wins), pct(r.losses), pct(r.timeouts),
+                                         secs(r.meanSurvivalTicks), secs(r.medianSurvivalTicks),
+                                         secs(r.p90SurvivalTicks), r.meanPelletsEaten);
+        for (int t = 0; t <= IntersectionRandom; ++t) {
+            if (r.caughtBy[t] > 0) {
+                line += QString::asprintf(" %s=%.1f%%", typeNames[t], pct(r.caughtBy[t]));
+            }
+        }
+        out << line << Qt::endl;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef BATCHSIMULATOR_H
+#define BATCHSIMULATOR_H
+
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QTextStream>
+
+#include "gamecore.h"
+
+// Plays many seeded games per round in parallel to tune ghost difficulty
+// without hand-playing. One game is one task on the simulator's own thread
+// pool, so sizing it leaves the global pool to asset decoding and path tables.
+class BatchSimulator
+{
+public:
+    enum Controller { RandomController, GreedyController };
+
+    struct Config {
+        int firstRound = 1;
+        int lastRound = 7;
+        int gamesPerRound = 1000;
+        int maxTicks = 20000;       // A game still running after this counts as timed out
+        quint64 seed = 1;           // Game i of round r is seeded from (seed, r, i)
+        Controller controller = RandomController;
+        int threads = 0;            // 0 = one per core
+    };
+
+    struct GameResult {
+        int round = 0;
+        GameCore::Status status = GameCore::Running;
+        int ticks = 0;
+        int pelletsEaten = 0;
+        int score = 0;
+        int caughtBy = -1;          // GhostType, -1 if not caught
+    };
+
+    struct RoundReport {
+        int round = 0;
+        int games = 0;
+        int wins = 0;
+        int losses = 0;
+        int timeouts = 0;
+        double meanSurvivalTicks = 0;
+        int medianSurvivalTicks = 0;
+        int p90SurvivalTicks = 0;
+        double meanPelletsEaten = 0;
+        int caughtBy[IntersectionRandom + 1] = {};
+    };
+
+    explicit BatchSimulator(const GameCore &prototype);
+
+    QVector<RoundReport> run(const Config &config);
+    qint64 lastRunNs() const { return m_lastRunNs; }
+
+    static void printReport(QTextStream &out, const QVector<RoundReport> &reports);
+
+private:
+    GameCore m_prototype; // Maze and path table loaded once, copied per game
+    qint64 m_lastRunNs;
+    QThreadPool m_pool;
+};
+
+#endif // BATCHSIMULATOR_H
@@ -0,0 +1,329 @@
+#include "clusterpaths.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QtConcurrent>
+#include <algorithm>
+#include <climits>
+#include <queue>
+
+static const int dCol[4] = { 0, 0, -1, 1 }; // Up, Down, Left, Right
+static const int dRow[4] = { -1, 1, 0, 0 };
+
+// Border stretches at least this long get a portal at each end instead of
+// one in the middle, so paths along wide open areas don't zig-zag
+#define LONG_ENTRANCE 6
+
+ClusterPaths::ClusterPaths()
+    : m_width(0),
+    m_height(0),
+    m_clustersX(0),
+    m_clustersY(0),
+    m_stamp(0)
+{
+}
+
+void ClusterPaths::clear()
+{
+    m_width = 0;
+    m_height = 0;
+    m_clustersX = 0;
+    m_clustersY = 0;
+    m_walls.clear();
+    m_component.clear();
+    m_portalCell.clear();
+    m_clusterPortals.clear();
+    m_edgeStart.clear();
+    m_edges.clear();
+    m_cost.clear();
+    m_firstDir.clear();
+    m_visited.clear();
+    m_stamp = 0;
+}
+
+void ClusterPaths::build(const QByteArray &walls, int width, int height)
+{
+    qDebug() << "Starting cluster path pre-computation...";
+    QElapsedTimer timer;
+    timer.start();
+
+    clear();
+    m_width = width;
+    m_height = height;
+    m_walls = walls;
+    m_clustersX = (width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    m_clustersY = (height + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    const int clusterCount = m_clustersX * m_clustersY;
+
+    // 1. Connected regions, so unreachable targets answer Stop right away
+    //    instead of searching the whole portal graph
+    m_component.fill(-1, width * height);
+    QVector<int> queue(width * height);
+    int components = 0;
+    for (int seed = 0; seed < width * height; ++seed) {
+        if (walls[seed] || m_component[seed] != -1) continue;
+        int head = 0, tail = 0;
+        queue[tail++] = seed;
+        m_component[seed] = components;
+        while (head < tail) {
+            int current = queue[head++];
+            int col = current % width, row = current / width;
+            for (int d = 0; d < 4; ++d) {
+                int c = col + dCol[d], r = row + dRow[d];
+                if (!isOpen(c, r) || m_component[r * width + c] != -1) continue;
+                m_component[r * width + c] = components;
+                queue[tail++] = r * width + c;
+            }
+        }
+        components++;
+    }
+    queue.clear();
+
+    // 2. Entrances on the right and bottom border of every cluster
+    QVector<QPair<QPoint, QPoint>> links;
+    for (int cy = 0; cy < m_clustersY; ++cy) {
+        for (int cx = 0; cx < m_clustersX; ++cx) {
+            if (cx + 1 < m_clustersX) {
+                int row0 = cy * CLUSTER_SIZE;
+                addEntrances(links, QPoint((cx + 1) * CLUSTER_SIZE - 1, row0), QPoint(0, 1), QPoint(1, 0),
+                             qMin(CLUSTER_SIZE, height - row0));
+            }
+            if (cy + 1 < m_clustersY) {
+                int col0 = cx * CLUSTER_SIZE;
+                addEntrances(links, QPoint(col0, (cy + 1) * CLUSTER_SIZE - 1), QPoint(1, 0), QPoint(0, 1),
+                             qMin(CLUSTER_SIZE, width - col0));
+            }
+        }
+    }
+
+    // 3. Number the portal cells cluster by cluster
+    QVector<qint64> keys;
+    keys.reserve(links.size() * 2);
+    for (const auto &link : links) {
+        keys.append((qint64(clusterOf(link.first)) << 32) | (link.first.y() * width + link.first.x()));
+        keys.append((qint64(clusterOf(link.second)) << 32) | (link.second.y() * width + link.second.x()));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    QHash<int, int> portalOfCell;
+    m_clusterPortals.fill(0, clusterCount + 1);
+    for (const qint64 key : keys) {
+        int cell = int(key & 0xFFFFFFFF);
+        portalOfCell.insert(cell, m_portalCell.size());
+        m_portalCell.append(QPoint(cell % width, cell / width));
+        m_clusterPortals[int(key >> 32) + 1]++;
+    }
+    for (int c = 0; c < clusterCount; ++c) {
+        m_clusterPortals[c + 1] += m_clusterPortals[c];
+    }
+
+    // 4. Edges: one step across each entrance, plus the walking distance
+    //    between every two portals of the same cluster. Clusters only write
+    //    the edge lists of their own portals, so they run in parallel.
+    const int portals = m_portalCell.size();
+    QVector<QVector<Edge>> portalEdges(portals);
+    for (const auto &link : links) {
+        int a = portalOfCell.value(link.first.y() * width + link.first.x());
+        int b = portalOfCell.value(link.second.y() * width + link.second.x());
+        portalEdges[a].append({ b, 1 });
+        portalEdges[b].append({ a, 1 });
+    }
+
+    QVector<int> clusters(clusterCount);
+    for (int c = 0; c < clusterCount; ++c) {
+        clusters[c] = c;
+    }
+    QVector<Edge> *edgeLists = portalEdges.data();
+    QtConcurrent::blockingMap(clusters, [this, edgeLists](int cluster) {
+        LocalSearch search;
+        for (int p = m_clusterPortals[cluster]; p < m_clusterPortals[cluster + 1]; ++p) {
+            searchCluster(m_portalCell[p], search);
+            for (int q = m_clusterPortals[cluster]; q < m_clusterPortals[cluster + 1]; ++q) {
+                int dist = search.dist[localIndex(m_portalCell[q])];
+                if (q != p && dist > 0) {
+                    edgeLists[p].append({ q, dist });
+                }
+            }
+        }
+    });
+
+    m_edgeStart.fill(0, portals + 1);
+    for (int p = 0; p < portals; ++p) {
+        m_edgeStart[p + 1] = m_edgeStart[p] + portalEdges[p].size();
+        m_edges += portalEdges[p];
+    }
+
+    m_cost.fill(0, portals);
+    m_firstDir.fill(-1, portals);
+    m_visited.fill(0, portals);
+
+    qDebug() << "Cluster path pre-computation complete. " << clusterCount << "clusters," << portals
+             << "portals," << m_edges.size() << "edges, in" << timer.elapsed() << "ms";
+}
+
+// Walks 'length' cell pairs (cell, cell + across) from 'first' along 'step'
+// and adds a link for every stretch where both sides are open
+void ClusterPaths::addEntrances(QVector<QPair<QPoint, QPoint>> &links, QPoint first, QPoint step,
+                                QPoint across, int length) const
+{
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        QPoint cell = first + step * i;
+        QPoint other = cell + across;
+        bool open = i < length && isOpen(cell.x(), cell.y()) && isOpen(other.x(), other.y());
+        if (open && runStart < 0) {
+            runStart = i;
+        } else if (!open && runStart >= 0) {
+            int runLength = i - runStart;
+            if (runLength >= LONG_ENTRANCE) {
+                links.append({ first + step * runStart, first + step * runStart + across });
+                links.append({ first + step * (i - 1), first + step * (i - 1) + across });
+            } else {
+                QPoint middle = first + step * (runStart + runLength / 2);
+                links.append({ middle, middle + across });
+            }
+            runStart = -1;
+        }
+    }
+}
+
+// BFS from 'from' that never leaves its cluster
+void ClusterPaths::searchCluster(QPoint from, LocalSearch &search) const
+{
+    const int x0 = from.x() - from.x() % CLUSTER_SIZE;
+    const int y0 = from.y() - from.y() % CLUSTER_SIZE;
+    const int x1 = qMin(x0 + CLUSTER_SIZE, m_width);
+    const int y1 = qMin(y0 + CLUSTER_SIZE, m_height);
+
+    std::fill(search.dist, search.dist + CLUSTER_SIZE * CLUSTER_SIZE, -1);
+    int queue[CLUSTER_SIZE * CLUSTER_SIZE];
+    int head = 0, tail = 0;
+    const int start = localIndex(from);
+    queue[tail++] = start;
+    search.dist[start] = 0;
+    search.firstDir[start] = Stop;
+
+    while (head < tail) {
+        int current = queue[head++];
+        int col = x0 + current % CLUSTER_SIZE;
+        int row = y0 + current / CLUSTER_SIZE;
+        for (int d = 0; d < 4; ++d) {
+            int c = col + dCol[d], r = row + dRow[d];
+            if (c < x0 || c >= x1 || r < y0 || r >= y1 || m_walls[r * m_width + c]) continue;
+            int next = (r - y0) * CLUSTER_SIZE + (c - x0);
+            if (search.dist[next] >= 0) continue;
+            search.dist[next] = search.dist[current] + 1;
+            search.firstDir[next] = (current == start) ? qint8(d) : search.firstDir[current];
+            queue[tail++] = next;
+        }
+    }
+}
+
+Direction ClusterPaths::nextDirection(QPoint fromCell, QPoint toCell) const
+{
+    if (fromCell == toCell || !isOpen(fromCell.x(), fromCell.y()) || !isOpen(toCell.x(), toCell.y())) {
+        return Stop;
+    }
+    if (m_component[fromCell.y() * m_width + fromCell.x()] != m_component[toCell.y() * m_width + toCell.x()]) {
+        return Stop;
+    }
+
+    // 1. Targets in the same cluster are usually reachable without leaving it
+    const int fromCluster = clusterOf(fromCell);
+    const int toCluster = clusterOf(toCell);
+    LocalSearch fromSearch;
+    searchCluster(fromCell, fromSearch);
+    if (fromCluster == toCluster && fromSearch.dist[localIndex(toCell)] > 0) {
+        return Direction(fromSearch.firstDir[localIndex(toCell)]);
+    }
+
+    // 2. Distances from every portal of the goal cluster to the goal
+    LocalSearch toSearch;
+    searchCluster(toCell, toSearch);
+
+    // 3. A* over the portals. Each portal carries the first move of the
+    //    best route to it; -1 marks the start cell itself being a portal.
+    if (++m_stamp == 0) {
+        m_visited.fill(0);
+        m_stamp = 1;
+    }
+
+    struct QueueEntry {
+        int f;
+        int cost;
+        int portal;
+        bool operator>(const QueueEntry &other) const
+        {
+            return f > other.f || (f == other.f && cost < other.cost);
+        }
+    };
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+
+    int bestTotal = INT_MAX;
+    Direction bestDir = Stop;
+    auto reach = [&](int portal, int cost, qint8 dir) {
+        if (m_visited[portal] == m_stamp && m_cost[portal] <= cost) return;
+        m_visited[portal] = m_stamp;
+        m_cost[portal] = cost;
+        m_firstDir[portal] = dir;
+
+        const QPoint cell = m_portalCell[portal];
+        if (dir >= 0 && clusterOf(cell) == toCluster) {
+            int toGoal = toSearch.dist[localIndex(cell)];
+            if (toGoal >= 0 && cost + toGoal < bestTotal) {
+                bestTotal = cost + toGoal;
+                bestDir = Direction(dir);
+            }
+        }
+        int heuristic = std::abs(cell.x() - toCell.x()) + std::abs(cell.y() - toCell.y());
+        open.push({ cost + heuristic, cost, portal });
+    };
+
+    for (int p = m_clusterPortals[fromCluster]; p < m_clusterPortals[fromCluster + 1]; ++p) {
+        int dist = fromSearch.dist[localIndex(m_portalCell[p])];
+        if (dist >= 0) {
+            reach(p, dist, dist == 0 ? qint8(-1) : fromSearch.firstDir[localIndex(m_portalCell[p])]);
+        }
+    }
+
+    // If the budget runs out first, head for the portal that got closest
+    int closestHeuristic = INT_MAX;
+    Direction closestDir = Stop;
+    int expansions = 0;
+    while (!open.empty()) {
+        const QueueEntry top = open.top();
+        open.pop();
+        if (top.f >= bestTotal) break; // Nothing left in the queue can beat it
+        if (m_cost[top.portal] != top.cost) continue; // Superseded by a cheaper route
+        if (++expansions > CLUSTER_MAX_EXPANSIONS) break;
+
+        const int p = top.portal;
+        const qint8 dir = m_firstDir[p];
+        if (dir >= 0 && top.f - top.cost < closestHeuristic) {
+            closestHeuristic = top.f - top.cost;
+            closestDir = Direction(dir);
+        }
+
+        for (int e = m_edgeStart[p]; e < m_edgeStart[p + 1]; ++e) {
+            const Edge &edge = m_edges[e];
+            qint8 nextDir = dir;
+            if (dir < 0) {
+                // Leaving the start cell: inside the cluster the local search
+                // knows the way, across the border it is a single step
+                QPoint target = m_portalCell[edge.to];
+                if (clusterOf(target) == fromCluster) {
+                    nextDir = fromSearch.firstDir[localIndex(target)];
+                } else {
+                    QPoint delta = target - m_portalCell[p];
+                    for (int d = 0; d < 4; ++d) {
+                        if (delta.x() == dCol[d] && delta.y() == dRow[d]) nextDir = qint8(d);
+                    }
+                }
+            }
+            reach(edge.to, top.cost + edge.cost, nextDir);
+        }
+    }
+
+    return bestTotal < INT_MAX ? bestDir : closestDir;
+}
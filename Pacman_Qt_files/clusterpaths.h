@@ -0,0 +1,82 @@
+#ifndef CLUSTERPATHS_H
+#define CLUSTERPATHS_H
+
+#include <QByteArray>
+#include <QPoint>
+#include <QVector>
+
+#include "gametypes.h"
+
+// Hierarchical path finder for mazes too big for the all-pairs PathTable.
+//
+// The maze is cut into CLUSTER_SIZE x CLUSTER_SIZE clusters. Every open
+// stretch of a cluster border gets a portal cell on each side, and the
+// portal-to-portal distances inside each cluster are computed once at build
+// time. A query only searches inside the start and goal clusters and runs
+// A* over the portal graph, so its cost depends on the distance travelled
+// and not on the maze size. CLUSTER_MAX_EXPANSIONS caps the A* work per
+// query to keep a frame's worth of ghost decisions inside the tick budget.
+#define CLUSTER_SIZE 16
+#define CLUSTER_MAX_EXPANSIONS 4096
+
+class ClusterPaths
+{
+public:
+    ClusterPaths();
+
+    // 'walls' holds width*height bytes, non-zero for a wall
+    void build(const QByteArray &walls, int width, int height);
+    void clear();
+
+    bool isEmpty() const { return m_width == 0; }
+    int portalCount() const { return m_portalCell.size(); }
+    int edgeCount() const { return m_edges.size(); }
+
+    // First move on a (near-)shortest path, Stop if already there or
+    // unreachable. Uses scratch buffers, so one instance must not be queried
+    // from two threads at once; copies are independent.
+    Direction nextDirection(QPoint fromCell, QPoint toCell) const;
+
+private:
+    struct Edge {
+        int to;
+        int cost;
+    };
+
+    // Distances and first moves from one cell, limited to its cluster
+    struct LocalSearch {
+        int dist[CLUSTER_SIZE * CLUSTER_SIZE];
+        qint8 firstDir[CLUSTER_SIZE * CLUSTER_SIZE];
+    };
+
+    bool isOpen(int col, int row) const
+    {
+        return col >= 0 && col < m_width && row >= 0 && row < m_height && !m_walls[row * m_width + col];
+    }
+    int clusterOf(QPoint cell) const { return (cell.y() / CLUSTER_SIZE) * m_clustersX + cell.x() / CLUSTER_SIZE; }
+    int localIndex(QPoint cell) const { return (cell.y() % CLUSTER_SIZE) * CLUSTER_SIZE + cell.x() % CLUSTER_SIZE; }
+    void searchCluster(QPoint from, LocalSearch &search) const;
+    void addEntrances(QVector<QPair<QPoint, QPoint>> &links, QPoint first, QPoint step, QPoint across, int length) const;
+
+    int m_width;
+    int m_height;
+    int m_clustersX;
+    int m_clustersY;
+    QByteArray m_walls;
+    QVector<int> m_component;          // Connected region per cell, -1 for walls
+
+    // Portals are numbered cluster by cluster, so the portals of cluster c
+    // are ids m_clusterPortals[c] .. m_clusterPortals[c + 1] - 1
+    QVector<QPoint> m_portalCell;
+    QVector<int> m_clusterPortals;
+    QVector<int> m_edgeStart;          // Edges of portal p: m_edgeStart[p] .. m_edgeStart[p + 1] - 1
+    QVector<Edge> m_edges;
+
+    // A* scratch, valid for a portal only when its stamp matches m_stamp
+    mutable QVector<int> m_cost;
+    mutable QVector<qint8> m_firstDir;
+    mutable QVector<quint32> m_visited;
+    mutable quint32 m_stamp;
+};
+
+#endif // CLUSTERPATHS_H
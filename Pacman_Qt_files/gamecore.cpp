@@ -0,0 +1,1010 @@
+#include "gamecore.h"
+#include <QDataStream>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <cmath>
+
+// === CONSTRUCTOR ===
+GameCore::GameCore()
+    : m_status(Running),
+    m_events(NoEvent),
+    m_score(0),
+    m_pelletsEaten(0),
+    m_pelletsLeft(0),
+    m_powerPelletsLeft(0),
+    m_caughtByType(-1),
+    m_round(1),
+    m_tick(0),
+    m_seed(0),
+    m_mazePellets(0),
+    m_mazePowerPellets(0),
+    startMacroRow(-1),
+    startMacroCol(-1),
+    m_pacmanDirection(Right),
+    m_pacmanMouthAngle(10),       // Start with mouth slightly open
+    m_pacmanMouthDirection(1),    // Mouth will open
+    m_pacmanAnimationCounter(0),
+    isMoving(false),
+    moveSteps(MOVESTEPS),
+    currentStep(0),
+    targetX(0),
+    targetY(0),
+    stepDeltaX(0),
+    stepDeltaY(0),
+    nextGhostId(0),
+    m_profiler(nullptr)
+{
+}
+
+// === GAME STATE MANAGEMENT ===
+
+bool GameCore::startRound(int round, bool resetScore, quint64 seed)
+{
+    if (!hasStartPosition()) {
+        qDebug() << "Start position 'p' not found!";
+        return false;
+    }
+
+    m_round = round;
+    m_seed = seed;
+    m_rng.reseed(seed);
+    if (resetScore) {
+        m_score = 0;
+    }
+    m_pelletsEaten = 0;
+    m_caughtByType = -1;
+
+    // Copy the original maze back into the working maze
+    m_maze = m_originalMaze;
+    m_pelletsLeft = m_mazePellets;
+    m_powerPelletsLeft = m_mazePowerPellets;
+
+    // Set Pac-Man's start position
+    QPoint gridCenter = macroGridToGridCenter(startMacroCol, startMacroRow);
+    pacman_grid_center = gridCenter;
+    pacman_macrogrid_center = QPoint(startMacroCol, startMacroRow);
+    m_pacmanDirection = Right;
+    isMoving = false;
+    currentStep = 0;
+
+    // Eat the pellet at the start
+    if (m_maze.test(MazeBits::Pellets, startMacroCol, startMacroRow)) {
+        m_maze.clear(MazeBits::Pellets, startMacroCol, startMacroRow);
+        m_pelletsLeft--;
+    }
+    if (m_maze.test(MazeBits::PowerPellets, startMacroCol, startMacroRow)) {
+        m_maze.clear(MazeBits::PowerPellets, startMacroCol, startMacroRow);
+        m_powerPelletsLeft--;
+    }
+
+    // Initialize ghosts (this will now use m_round)
+    initializeGhosts();
+
+    m_tick = 0;
+    m_timers.clear(m_tick);
+    m_status = Running;
+    return true;
+}
+
+int GameCore::step(Direction input)
+{
+    ProfileScope tickScope(profile(Profiler::Tick));
+    m_events = NoEvent;
+    if (m_status != Running) {
+        return m_events;
+    }
+
+    // Timed effects due this tick fire before the tick itself runs
+    updateTimers();
+
+    applyInput(input);
+
+    // 1. Run Pac-Man's animation (if he's moving)
+    if (isMoving) {
+        animationStep();
+
+        // Animate Pac-Man's mouth
+        m_pacmanAnimationCounter++;
+        if (m_pacmanAnimationCounter > 2) { // Change every 3 frames
+            m_pacmanAnimationCounter = 0;
+            m_pacmanMouthAngle += m_pacmanMouthDirection * 15;
+            // Reverse direction if mouth is fully open or closed
+            if (m_pacmanMouthAngle >= 45 || m_pacmanMouthAngle <= 0) {
+                m_pacmanMouthDirection *= -1;
+            }
+        }
+    }
+
+    // 2. Run the Ghost's animation/AI step
+    {
+        ProfileScope ghostScope(profile(Profiler::GhostStep));
+        ghostAnimationStep();
+    }
+
+    // 3. Check for collisions
+    {
+        ProfileScope collisionScope(profile(Profiler::Collisions));
+        checkGhostCollisions();
+    }
+
+    m_tick++;
+    return m_events;
+}
+
+QVector<Ghost> GameCore::ghostList() const
+{
+    QVector<Ghost> list;
+    list.reserve(m_ghosts.count());
+    for (int slot = 0; slot < m_ghosts.end(); ++slot) {
+        if (m_ghosts.state[slot] & GhostPool::InUse) {
+            list.append(m_ghosts.ghost(slot));
+        }
+    }
+    return list;
+}
+
+// === SNAPSHOTS ===
+
+#define STATE_VERSION 2
+
+QByteArray GameCore::saveState() const
+{
+    QByteArray state;
+    QDataStream out(&state, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    out << quint8(STATE_VERSION);
+    out << qint32(m_status) << qint32(m_score) << qint32(m_pelletsEaten) << qint32(m_caughtByType)
+        << qint32(m_round) << m_tick << m_seed;
+    for (int i = 0; i < 4; ++i) {
+        out << m_rng.state(i);
+    }
+
+    // Cell values are 0-4, one byte each
+    out << m_maze.toCells();
+
+    out << pacman_grid_center << pacman_macrogrid_center << qint32(m_pacmanDirection)
+        << qint32(m_pacmanMouthAngle) << qint32(m_pacmanMouthDirection) << qint32(m_pacmanAnimationCounter)
+        << isMoving << qint32(moveSteps) << qint32(currentStep) << qint32(targetX) << qint32(targetY)
+        << qint32(stepDeltaX) << qint32(stepDeltaY);
+
+    // Timers are saved as the tick counters they replaced, so the format
+    // does not depend on the scheduler
+    out << qint32(nextGhostId) << qint32(ticksLeft(m_panicTimer)) << qint32(m_ghosts.count());
+    for (int slot = 0; slot < m_ghosts.end(); ++slot) {
+        if (!(m_ghosts.state[slot] & GhostPool::InUse)) continue;
+        Ghost ghost = m_ghosts.ghost(slot);
+        out << ghost.grid_center << ghost.macrogrid_center << qint32(ghost.type) << qint32(ghost.mode)
+            << qint32(ghost.direction) << qint32(ghost.color.r) << qint32(ghost.color.g) << qint32(ghost.color.b)
+            << ghost.active << ghost.moving << ghost.respawning << qint32(ticksLeft(m_respawnTimers[slot]))
+            << qint32(ghost.moveSteps) << qint32(ghost.currentStep) << qint32(ghost.stepDeltaX)
+            << qint32(ghost.stepDeltaY) << qint32(ghost.failCounter) << ghost.speedMultiplier
+            << qint32(ghost.delayCounter) << qint32(ghost.parentId);
+    }
+    return state;
+}
+
+bool GameCore::restoreState(const QByteArray &state)
+{
+    QDataStream in(state);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint8 version;
+    in >> version;
+    if (version != STATE_VERSION) {
+        qDebug() << "Unsupported game state version" << version;
+        return false;
+    }
+
+    qint32 status, score, pelletsEaten, caughtByType, round;
+    in >> status >> score >> pelletsEaten >> caughtByType >> round >> m_tick >> m_seed;
+    m_status = Status(status);
+    m_score = score;
+    m_pelletsEaten = pelletsEaten;
+    m_caughtByType = caughtByType;
+    m_round = round;
+    for (int i = 0; i < 4; ++i) {
+        quint64 word;
+        in >> word;
+        m_rng.setState(i, word);
+    }
+
+    QByteArray cells;
+    in >> cells;
+    if (cells.size() != mazeWidth() * mazeHeight()) {
+        qDebug() << "Game state does not match the loaded maze";
+        return false;
+    }
+    m_maze = MazeBits::fromCells(cells, mazeWidth(), mazeHeight());
+    countPellets();
+
+    qint32 direction, mouthAngle, mouthDirection, animationCounter, steps, step, tx, ty, dx, dy;
+    in >> pacman_grid_center >> pacman_macrogrid_center >> direction >> mouthAngle >> mouthDirection
+        >> animationCounter >> isMoving >> steps >> step >> tx >> ty >> dx >> dy;
+    m_pacmanDirection = Direction(direction);
+    m_pacmanMouthAngle = mouthAngle;
+    m_pacmanMouthDirection = mouthDirection;
+    m_pacmanAnimationCounter = animationCounter;
+    moveSteps = steps;
+    currentStep = step;
+    targetX = tx;
+    targetY = ty;
+    stepDeltaX = dx;
+    stepDeltaY = dy;
+
+    qint32 ghostId, panicTicks, savedGhosts;
+    in >> ghostId >> panicTicks >> savedGhosts;
+    nextGhostId = ghostId;
+    m_timers.clear(m_tick);
+    if (panicTicks > 0) {
+        m_panicTimer = m_timers.schedule(m_tick + panicTicks - 1, PanicTimeout);
+    }
+    clearGhosts();
+    for (int i = 0; i < savedGhosts && in.status() == QDataStream::Ok; ++i) {
+        Ghost ghost;
+        qint32 type, mode, dir, r, g, b, respawnTicks, gSteps, gStep, gdx, gdy, failCounter, delayCounter,
+            parentId;
+        in >> ghost.grid_center >> ghost.macrogrid_center >> type >> mode >> dir >> r >> g >> b
+            >> ghost.active >> ghost.moving >> ghost.respawning >> respawnTicks >> gSteps >> gStep
+            >> gdx >> gdy >> failCounter >> ghost.speedMultiplier >> delayCounter >> parentId;
+        ghost.type = GhostType(type);
+        ghost.mode = GhostMode(mode);
+        ghost.direction = Direction(dir);
+        ghost.color = { r, g, b };
+        ghost.moveSteps = gSteps;
+        ghost.currentStep = gStep;
+        ghost.stepDeltaX = gdx;
+        ghost.stepDeltaY = gdy;
+        ghost.failCounter = failCounter;
+        ghost.delayCounter = delayCounter;
+        ghost.parentId = parentId;
+        GhostHandle handle = addGhost(ghost);
+        if (ghost.respawning && handle.slot >= 0) {
+            m_respawnTimers[handle.slot] = m_timers.schedule(m_tick + qMax(respawnTicks, 1) - 1, GhostRespawn, handle);
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Game state is truncated";
+        return false;
+    }
+    return true;
+}
+
+void GameCore::applyInput(Direction input)
+{
+    if (isMoving) {
+        return; // Ignore commands while already moving
+    }
+
+    switch (input) {
+    case Up:
+        if (canMove(0, -1)) {
+            m_pacmanDirection = Up;
+            startAnimatedMove(0, -TILE_SIZE);
+        }
+        break;
+    case Down:
+        if (canMove(0, 1)) {
+            m_pacmanDirection = Down;
+            startAnimatedMove(0, TILE_SIZE);
+        }
+        break;
+    case Left:
+        if (canMove(-1, 0)) {
+            m_pacmanDirection = Left;
+            startAnimatedMove(-TILE_SIZE, 0);
+        }
+        break;
+    case Right:
+        if (canMove(1, 0)) {
+            m_pacmanDirection = Right;
+            startAnimatedMove(TILE_SIZE, 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void GameCore::updateTimers()
+{
+    m_timers.advance(m_tick, [this](int kind, GhostHandle ghost) {
+        switch (kind) {
+        case PanicTimeout:
+            panicModeTimeout();
+            break;
+        case GhostRespawn:
+            if (m_ghosts.isValid(ghost)) respawnGhost(ghost.slot);
+            break;
+        }
+    });
+}
+
+int GameCore::ticksLeft(TimerHandle timer) const
+{
+    // A counter of n used to run out n - 1 ticks after the save, on the
+    // step that decremented it to zero
+    if (!m_timers.isPending(timer)) return 0;
+    return int(m_timers.dueTick(timer) - m_tick) + 1;
+}
+
+void GameCore::precomputePaths()
+{
+    const int width = mazeWidth();
+    const int height = mazeHeight();
+    QByteArray walls(width * height, 0);
+    int openCells = 0;
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            bool wall = m_maze.test(MazeBits::Walls, c, r);
+            walls[r * width + c] = wall ? 1 : 0;
+            if (!wall) openCells++;
+        }
+    }
+
+    // The all-pairs table grows with the square of the open cells; past the
+    // budget the cluster search answers the same queries from O(N) data
+    if (PathTable::tableBytesFor(openCells) > PATH_TABLE_MAX_BYTES) {
+        m_paths.clear();
+        m_clusterPaths.build(walls, width, height);
+    } else {
+        m_clusterPaths.clear();
+        m_paths.build(walls, width, height,
+                      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/paths");
+    }
+}
+
+Direction GameCore::pathDirection(QPoint fromCell, QPoint toCell) const
+{
+    if (!m_clusterPaths.isEmpty()) {
+        return m_clusterPaths.nextDirection(fromCell, toCell);
+    }
+    return m_paths.nextDirection(fromCell, toCell);
+}
+
+// ##################################################################
+// ##################################################################
+// ###                                                            ###
+// ###     ALL YOUR PORTED CORE GAME LOGIC GOES BELOW THIS LINE   ###
+// ###   (These are from your mainwindow.cpp, adapted for TILE_SIZE) ###
+// ###                                                            ###
+// ##################################################################
+// ##################################################################
+
+// === ADAPTED from your logic ===
+QPoint GameCore::macroGridToGridCenter(int macroCol, int macroRow)
+{
+    // Returns the PIXEL center of a macro grid cell
+    int gridX = macroCol * TILE_SIZE + (TILE_SIZE / 2);
+    int gridY = macroRow * TILE_SIZE + (TILE_SIZE / 2);
+    return QPoint(gridX, gridY);
+}
+
+// === ADAPTED from your logic ===
+QPoint GameCore::gridToMacroGrid(int gridX, int gridY) const
+{
+    // Returns the macro grid cell (col, row) for a given PIXEL coordinate
+    int macroCol = gridX / TILE_SIZE;
+    int macroRow = gridY / TILE_SIZE;
+    macroCol = qBound(0, macroCol, mazeWidth() - 1);
+    macroRow = qBound(0, macroRow, mazeHeight() - 1);
+    return QPoint(macroCol, macroRow);
+}
+
+// === ADAPTED from your logic ===
+void GameCore::startAnimatedMove(int tx, int ty) // tx, ty are 0 or +/- TILE_SIZE
+{
+    if (isMoving) return;
+
+    targetX = tx;
+    targetY = ty;
+    currentStep = 0;
+    isMoving = true;
+
+    // Calculate pixel delta per step
+    stepDeltaX = (tx != 0) ? (tx / moveSteps) : 0; // e.g., 32 / 8 = 4 pixels
+    stepDeltaY = (ty != 0) ? (ty / moveSteps) : 0; // e.g., 32 / 8 = 4 pixels
+}
+
+// === ADAPTED from your logic ===
+bool GameCore::canMove(int tx, int ty) const // tx, ty are -1, 0, or 1 (macro grid delta)
+{
+    int newMacroCol = pacman_macrogrid_center.x() + tx;
+    int newMacroRow = pacman_macrogrid_center.y() + ty;
+
+    // Walls and the maze edge both block
+    return !m_maze.isWall(newMacroCol, newMacroRow);
+}
+
+// === ADAPTED from your logic ===
+void GameCore::animationStep() // Pac-Man's movement
+{
+    if (!isMoving) {
+        return;
+    }
+    currentStep++;
+
+    // Move Pac-Man's pixel center
+    pacman_grid_center.setX(pacman_grid_center.x() + stepDeltaX);
+    pacman_grid_center.setY(pacman_grid_center.y() + stepDeltaY);
+
+    if (currentStep >= moveSteps) {
+        // Finished moving
+        isMoving = false;
+
+        // Snap to the new grid cell's center
+        pacman_macrogrid_center = gridToMacroGrid(pacman_grid_center.x(), pacman_grid_center.y());
+        pacman_grid_center = macroGridToGridCenter(pacman_macrogrid_center.x(), pacman_macrogrid_center.y());
+
+        // Check for pellet
+        collectPellet();
+    }
+}
+
+// === ADAPTED from your logic ===
+bool GameCore::loadMaze(const QString &filename)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Could not open file:" << filename;
+        return false;
+    }
+
+    // Read every line first: the longest one sets the width
+    QTextStream in(&file);
+    QStringList lines;
+    int width = 0;
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        lines.append(line);
+        width = qMax(width, int(line.length()));
+    }
+    while (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    int height = lines.size();
+    if (width == 0 || height == 0 || width > MAZE_MAX_SIDE || height > MAZE_MAX_SIDE) {
+        qDebug() << "Maze" << filename << "has an unsupported size:" << width << "x" << height;
+        return false;
+    }
+
+    m_mazeFile = filename;
+    startMacroRow = -1;
+    startMacroCol = -1;
+    ghostSpawnPositions.clear();
+
+    // Short lines are padded with walls
+    QByteArray cells(width * height, 1);
+    for (int row = 0; row < height; row++) {
+        const QString &line = lines[row];
+        for (int col = 0; col < line.length(); col++) {
+            QChar ch = line[col];
+            int value;
+            if (ch == '1') value = 1;
+            else if (ch == '3' || ch == 'g') {
+                value = 3;
+                if (ch == 'g') ghostSpawnPositions.append(QPoint(col, row));
+            }
+            else if (ch == '4') value = 4;
+            else if (ch == '2') value = 2;
+            else {
+                value = 0;
+                if (ch == 'p') {
+                    startMacroCol = col;
+                    startMacroRow = row;
+                }
+            }
+            cells[row * width + col] = char(value);
+        }
+    }
+    m_originalMaze = MazeBits::fromCells(cells, width, height);
+    m_maze = m_originalMaze;
+    m_cellInfo = m_originalMaze.cellInfo();
+    countPellets();
+    m_mazePellets = m_pelletsLeft;
+    m_mazePowerPellets = m_powerPelletsLeft;
+    file.close();
+    precomputePaths();
+    qDebug() << "Loaded maze" << filename << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+// === ADAPTED from your logic ===
+void GameCore::collectPellet()
+{
+    int macroCol = pacman_macrogrid_center.x();
+    int macroRow = pacman_macrogrid_center.y();
+
+    if (m_maze.isWall(macroCol, macroRow)) {
+        return;
+    }
+
+    if (m_maze.test(MazeBits::Pellets, macroCol, macroRow)) {
+        m_score += 1;
+        m_pelletsEaten++;
+        m_maze.clear(MazeBits::Pellets, macroCol, macroRow); // Set to empty path
+        m_pelletsLeft--;
+        m_events |= PelletEaten;
+    } else if (m_maze.test(MazeBits::PowerPellets, macroCol, macroRow)) {
+        m_score += 5;
+        m_pelletsEaten++;
+        m_maze.clear(MazeBits::PowerPellets, macroCol, macroRow);
+        m_powerPelletsLeft--;
+        activatePanicMode();
+        m_events |= PowerPelletEaten;
+    }
+
+    if (checkAllPelletsCollected()) {
+        // Round is cleared!
+        m_status = Won;
+        m_events |= RoundCleared;
+    }
+}
+
+// === ADAPTED from your logic ===
+bool GameCore::checkAllPelletsCollected()
+{
+    return m_pelletsLeft == 0 && m_powerPelletsLeft == 0;
+}
+
+// Full scan, only when a maze is loaded or a snapshot restored
+void GameCore::countPellets()
+{
+    m_pelletsLeft = m_maze.count(MazeBits::Pellets);
+    m_powerPelletsLeft = m_maze.count(MazeBits::PowerPellets);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::activatePanicMode()
+{
+    for (int slot = 0; slot < m_ghosts.end(); ++slot) {
+        if (m_ghosts.state[slot] & GhostPool::Active) {
+            m_ghosts.mode[slot] = Panic;
+            // Color is handled by drawGhost
+        }
+    }
+    // 10 seconds, restarts if already running
+    m_timers.cancel(m_panicTimer);
+    m_panicTimer = m_timers.schedule(m_tick + PANIC_TICKS, PanicTimeout);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::panicModeTimeout()
+{
+    for (int slot = 0; slot < m_ghosts.end(); ++slot) {
+        if (m_ghosts.state[slot] & GhostPool::Active) {
+            m_ghosts.mode[slot] = Chase;
+            // Color is handled by drawGhost
+        }
+    }
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::ghostAnimationStep()
+{
+    if (m_status != Running) return;
+
+    // Slots are in spawn order and end() is re-read every pass, so a child
+    // spawned this tick still gets its first move this tick
+    for (int slot = 0; slot < m_ghosts.end(); slot++) {
+        quint8 state = m_ghosts.state[slot];
+        if ((state & (GhostPool::Active | GhostPool::Respawning)) != GhostPool::Active) continue;
+
+        quint8 delay = m_ghosts.delayTicks[slot];
+        if (delay > 1) {
+            if (++m_ghosts.delayCounter[slot] < delay) {
+                continue;
+            }
+            m_ghosts.delayCounter[slot] = 0;
+        }
+
+        if (!(state & GhostPool::Moving)) {
+            const QPoint cell = m_ghosts.cell[slot];
+            if (m_ghosts.traits[slot].type == IntersectionRandom &&
+                (cellInfo(cell.x(), cell.y()).flags & CELL_JUNCTION)) {
+                if (m_rng.bounded(100) < REPRODUCTION_PROB) {
+                    spawnChildGhost(slot);
+                }
+            }
+            moveGhost(slot);
+            continue;
+        }
+
+        QPoint &center = m_ghosts.center[slot];
+        center += m_ghosts.stepDelta[slot];
+        if (++m_ghosts.currentStep[slot] >= m_ghosts.moveSteps[slot]) {
+            m_ghosts.state[slot] = state & ~GhostPool::Moving;
+            m_ghosts.cell[slot] = gridToMacroGrid(center.x(), center.y());
+            center = macroGridToGridCenter(m_ghosts.cell[slot].x(), m_ghosts.cell[slot].y());
+        }
+        m_ghostTiles.place(slot, gridToMacroGrid(center.x(), center.y()));
+    }
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::checkGhostCollisions()
+{
+    // Only ghosts on Pac-Man's tile or next to it can be close enough. Hits
+    // go into a slot bitmask, which also puts them back in slot order.
+    static_assert(MAX_GHOSTS <= 32, "contact mask holds one bit per ghost slot");
+    quint32 contacts = 0;
+    const QPoint pacmanTile = gridToMacroGrid(pacman_grid_center.x(), pacman_grid_center.y());
+    m_ghostTiles.forEachNear(pacmanTile, [&](int slot) {
+        if ((m_ghosts.state[slot] & (GhostPool::Active | GhostPool::Respawning)) != GhostPool::Active) return;
+
+        // Pixel-based collision check
+        const QPoint center = m_ghosts.center[slot];
+        int dist = std::abs(pacman_grid_center.x() - center.x()) +
+                   std::abs(pacman_grid_center.y() - center.y());
+        if (dist < TILE_SIZE / 1.5) { // If centers are close
+            contacts |= quint32(1) << slot;
+        }
+    });
+
+    // Every frightened ghost touched this tick is eaten, even when another
+    // one catches Pac-Man
+    int caughtBy = -1;
+    for (int slot = 0; contacts; ++slot, contacts >>= 1) {
+        if (!(contacts & 1)) continue;
+        if (m_ghosts.mode[slot] == Chase) {
+            if (caughtBy < 0) caughtBy = slot;
+            continue;
+        }
+        qDebug() << "Pacman ate ghost!";
+        m_score += 50;
+        m_ghosts.state[slot] = (m_ghosts.state[slot] & ~GhostPool::Active) | GhostPool::Respawning;
+        m_respawnTimers[slot] = m_timers.schedule(m_tick + RESPAWN_TICKS, GhostRespawn,
+                                                  m_ghosts.handle(slot)); // Comes back in 2 seconds
+        m_events |= GhostEaten;
+    }
+
+    if (caughtBy >= 0) {
+        qDebug() << "Ghost caught Pacman! Game Over!";
+        m_status = Lost;
+        m_caughtByType = m_ghosts.traits[caughtBy].type;
+        m_events |= PacmanCaught;
+    }
+}
+
+// === PORTED from your logic (Unchanged) ===
+Color GameCore::getGhostColor(const Ghost &ghost)
+{
+    // This is your exact function, just without the panic part
+    switch (ghost.type) {
+    case Original:
+        return {255, 0, 0}; // Red
+    case AggressiveChaser:
+        return {255, 165, 0}; // Orange
+    case Ambusher:
+        return {255, 105, 180}; // Pink
+    case RandomPatrol:
+        return {0, 255, 255}; // Cyan
+    case IntersectionRandom:
+        return {255, 255, 0}; // Yellow
+    default:
+        return {255, 0, 0};
+    }
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::initializeGhosts()
+{
+    clearGhosts();
+    nextGhostId = 0;
+
+    if (ghostSpawnPositions.isEmpty()) return;
+
+    int numGhosts = 0;
+    if (m_round == 1) numGhosts = 0;
+    if (m_round == 2) numGhosts = 1;
+    if (m_round == 3) numGhosts = 2;
+    if (m_round == 4) numGhosts = 3;
+    if (m_round == 5) numGhosts = 4;
+    if (m_round == 6) numGhosts = 4;
+    if (m_round == 7) numGhosts = 1;
+
+    for (int i = 0; i < numGhosts && i < ghostSpawnPositions.size(); i++) {
+        Ghost ghost;
+        GhostType type;
+        if (m_round == 7) type = IntersectionRandom;
+        else if (i == 0) type = Original;
+        else if (i == 1) type = IntersectionRandom;
+        else if (i == 2) type = Ambusher;
+        else type = RandomPatrol;
+        initializeGhost(ghost, i, type);
+        if (m_round == 6) {
+            if (i == 0) ghost.speedMultiplier = 0.5f;
+            else if (i == 1) ghost.speedMultiplier = 0.7f;
+            else if (i == 2) ghost.speedMultiplier = 0.9f;
+            else if (i == 3) ghost.speedMultiplier = 1.1f;
+        }
+        if (m_round == 7) {
+            ghost.speedMultiplier = 0.5f;
+        }
+        addGhost(ghost);
+    }
+}
+
+void GameCore::clearGhosts()
+{
+    m_ghosts.clear();
+    m_ghostTiles.reset(mazeWidth(), mazeHeight(), m_ghosts.capacity());
+}
+
+// Spawns a ghost and files it under its tile; a full pool drops it
+GhostHandle GameCore::addGhost(const Ghost &ghost)
+{
+    GhostHandle handle = m_ghosts.spawn(ghost);
+    if (handle.slot >= 0) {
+        m_ghostTiles.place(handle.slot, gridToMacroGrid(ghost.grid_center.x(), ghost.grid_center.y()));
+    }
+    return handle;
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::initializeGhost(Ghost &ghost, int spawnIndex, GhostType type)
+{
+    QPoint spawnMacro = ghostSpawnPositions[spawnIndex % ghostSpawnPositions.size()];
+    QPoint spawnGrid = macroGridToGridCenter(spawnMacro.x(), spawnMacro.y());
+
+    ghost.grid_center = spawnGrid;
+    ghost.macrogrid_center = spawnMacro;
+    ghost.type = type;
+    ghost.active = true;
+    ghost.mode = Chase;
+    ghost.direction = Stop;
+    ghost.moving = false;
+    ghost.moveSteps = MOVESTEPS; // Adapted
+    ghost.currentStep = 0;
+    ghost.stepDeltaX = 0;
+    ghost.stepDeltaY = 0;
+    ghost.respawning = false;
+    ghost.failCounter = 0;
+    ghost.speedMultiplier = 1.0f;
+    ghost.delayCounter = 0;
+    ghost.parentId = nextGhostId++;
+    ghost.color = getGhostColor(ghost); // Set its color
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::respawnGhost(int slot)
+{
+    Ghost ghost = m_ghosts.ghost(slot);
+    if (ghostSpawnPositions.isEmpty()) {
+        ghost.respawning = false;
+        m_ghosts.store(slot, ghost);
+        return;
+    }
+    QPoint spawnMacro = ghostSpawnPositions[0];
+    QPoint spawnGrid = macroGridToGridCenter(spawnMacro.x(), spawnMacro.y());
+
+    ghost.grid_center = spawnGrid;
+    ghost.macrogrid_center = spawnMacro;
+    ghost.active = true;
+    ghost.respawning = false;
+    ghost.mode = Chase;
+    ghost.direction = Stop;
+    ghost.moving = false;
+    ghost.currentStep = 0;
+    // Color is set automatically by drawGhost
+    m_ghosts.store(slot, ghost);
+    m_ghostTiles.place(slot, spawnMacro);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::spawnChildGhost(int parentSlot)
+{
+    if (ghostSpawnPositions.isEmpty() || m_ghosts.isFull()) return;
+    Ghost child;
+    child.grid_center = m_ghosts.center[parentSlot];
+    child.macrogrid_center = m_ghosts.cell[parentSlot];
+    child.type = IntersectionRandom;
+    child.active = true;
+    child.mode = Chase;
+    child.direction = Stop;
+    child.moving = false;
+    child.moveSteps = MOVESTEPS; // Adapted
+    child.currentStep = 0;
+    child.stepDeltaX = 0;
+    child.stepDeltaY = 0;
+    child.respawning = false;
+    child.failCounter = 0;
+    child.speedMultiplier = 0.5f;
+    child.delayCounter = 0;
+    child.parentId = nextGhostId++;
+    child.color = getGhostColor(child);
+    addGhost(child);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+void GameCore::moveGhost(int slot)
+{
+    // Decisions are rare next to steps, so they work on a gathered copy
+    Ghost ghost = m_ghosts.ghost(slot);
+    if (!ghost.active || ghost.moving) return;
+
+    ghost.direction = getGhostDirection(ghost);
+
+    if (ghost.direction == Stop) {
+        m_ghosts.store(slot, ghost);
+        return;
+    }
+
+    ghost.moving = true;
+    ghost.currentStep = 0;
+    ghost.moveSteps = MOVESTEPS; // Adapted
+
+    int stepSize = TILE_SIZE / ghost.moveSteps; // e.g., 4 pixels
+    switch (ghost.direction) {
+    case Up:    ghost.stepDeltaX = 0; ghost.stepDeltaY = -stepSize; break;
+    case Down:  ghost.stepDeltaX = 0; ghost.stepDeltaY = stepSize;  break;
+    case Left:  ghost.stepDeltaX = -stepSize; ghost.stepDeltaY = 0; break;
+    case Right: ghost.stepDeltaX = stepSize;  ghost.stepDeltaY = 0; break;
+    default:    ghost.moving = false; break;
+    }
+    m_ghosts.store(slot, ghost);
+}
+
+// === PORTED from your logic (Unchanged) ===
+Direction GameCore::getGhostDirection(Ghost &ghost)
+{
+    if (ghost.mode == Panic) {
+        return getGhostPanicDirection(ghost);
+    }
+    switch (ghost.type) {
+    case Original: return getGhostChaseDirection(ghost);
+    case AggressiveChaser: return getAggressiveChaserDirection(ghost);
+    case Ambusher: return getAmbusherDirection(ghost);
+    case RandomPatrol: return getRandomPatrolDirection(ghost);
+    case IntersectionRandom: return getIntersectionRandomDirection(ghost);
+    default: return getGhostChaseDirection(ghost);
+    }
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getGhostChaseDirection(Ghost &ghost)
+{
+    // Stop if ghost is already at the target (or either cell is a wall)
+    return pathDirection(ghost.macrogrid_center, pacman_macrogrid_center);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getAggressiveChaserDirection(Ghost &ghost)
+{
+    ghost.failCounter++;
+    if (ghost.failCounter >= 8) {
+        ghost.failCounter = 0;
+        if (quint8 exits = ghostExits(ghost)) {
+            return randomExit(exits);
+        }
+    }
+    return getGhostChaseDirection(ghost);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getAmbusherDirection(Ghost &ghost)
+{
+    QPoint ghostMacro = ghost.macrogrid_center;
+    QPoint pacmanMacro = pacman_macrogrid_center;
+    QPoint targetMacro = pacmanMacro;
+
+    // Target 4 tiles ahead of Pac-Man
+    switch(m_pacmanDirection) {
+    case Up:    targetMacro.setY(targetMacro.y() - 4); break;
+    case Down:  targetMacro.setY(targetMacro.y() + 4); break;
+    case Left:  targetMacro.setX(targetMacro.x() - 4); break;
+    case Right: targetMacro.setX(targetMacro.x() + 4); break;
+    default: break;
+    }
+
+    // Clamp to maze bounds
+    targetMacro.setX(qBound(0, targetMacro.x(), mazeWidth() - 1));
+    targetMacro.setY(qBound(0, targetMacro.y(), mazeHeight() - 1));
+
+    // If target is a wall or invalid, default to chasing Pac-Man directly
+    if (m_maze.isWall(targetMacro.x(), targetMacro.y())) {
+        targetMacro = pacmanMacro;
+    }
+
+    return pathDirection(ghostMacro, targetMacro);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getRandomPatrolDirection(Ghost &ghost)
+{
+    if (ghost.direction != Stop && m_rng.bounded(100) < 70) {
+        if (canGhostMove(ghost, ghost.direction)) {
+            return ghost.direction;
+        }
+    }
+    if (quint8 exits = ghostExits(ghost)) {
+        return randomExit(exits);
+    }
+    return Stop;
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getIntersectionRandomDirection(Ghost &ghost)
+{
+    if (isAtIntersection(ghost)) {
+        if (quint8 exits = ghostExits(ghost)) {
+            return randomExit(exits);
+        }
+    } else {
+        if (ghost.direction != Stop && canGhostMove(ghost, ghost.direction)) {
+            return ghost.direction;
+        }
+        if (quint8 exits = ghostExits(ghost)) {
+            return randomExit(exits);
+        }
+    }
+    return Stop;
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+Direction GameCore::getGhostPanicDirection(Ghost &ghost)
+{
+    // Run to a random valid neighbor
+    if (isAtIntersection(ghost) && m_rng.bounded(100) < 50) {
+        if (quint8 exits = ghostExits(ghost)) {
+            return randomExit(exits);
+        }
+    }
+
+    // Try to run away from Pac-Man
+    QPoint ghostMacro = ghost.macrogrid_center;
+    QPoint pacmanMacro = pacman_macrogrid_center;
+    int dx = ghostMacro.x() - pacmanMacro.x();
+    int dy = ghostMacro.y() - pacmanMacro.y();
+
+    if (std::abs(dx) > std::abs(dy)) {
+        if (dx > 0 && canGhostMove(ghost, Right)) return Right;
+        if (dx < 0 && canGhostMove(ghost, Left)) return Left;
+    } else {
+        if (dy > 0 && canGhostMove(ghost, Down)) return Down;
+        if (dy < 0 && canGhostMove(ghost, Up)) return Up;
+    }
+
+    // Fallback to random
+    return getRandomPatrolDirection(ghost);
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+bool GameCore::canGhostMove(const Ghost &ghost, Direction dir)
+{
+    // The exits mask leaves out walls only; ghosts may still enter spawn cells
+    return dir != Stop && (ghostExits(ghost) >> dir) & 1;
+}
+
+// === ADAPTED from your logic (Ghosts) ===
+bool GameCore::isAtIntersection(const Ghost &ghost)
+{
+    return cellInfo(ghost.macrogrid_center.x(), ghost.macrogrid_center.y()).flags & CELL_JUNCTION;
+}
+
+quint8 GameCore::ghostExits(const Ghost &ghost) const
+{
+    return cellInfo(ghost.macrogrid_center.x(), ghost.macrogrid_center.y()).flags & CELL_EXITS;
+}
+
+// Uniform pick among the set exit bits, in Up, Down, Left, Right order, so
+// it draws exactly like picking from a list of the valid directions
+Direction GameCore::randomExit(quint8 exits)
+{
+    int pick = m_rng.bounded(int(qPopulationCount(exits)));
+    for (int dir = Up; dir <= Right; ++dir) {
+        if (((exits >> dir) & 1) && pick-- == 0) {
+            return Direction(dir);
+        }
+    }
+    return Stop;
+}
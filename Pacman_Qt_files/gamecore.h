@@ -0,0 +1,199 @@
+#ifndef GAMECORE_H
+#define GAMECORE_H
+
+#include <QByteArray>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+#include "clusterpaths.h"
+#include "gamerng.h"
+#include "gametypes.h"
+#include "ghostpool.h"
+#include "mazebits.h"
+#include "pathtable.h"
+#include "profiler.h"
+#include "tickscheduler.h"
+#include "tileindex.h"
+
+// The whole game simulation: maze, Pac-Man, ghosts and score.
+// Plain C++ on top of QtCore only, so it runs without a QWidget (headless
+// runs, benchmarks, soak tests). One call to step() is one game tick.
+class GameCore
+{
+public:
+    enum Status { Running, Won, Lost };
+
+    // Bit flags returned by step() so the front end can play sounds etc.
+    enum Event {
+        NoEvent          = 0x00,
+        PelletEaten      = 0x01,
+        PowerPelletEaten = 0x02,
+        GhostEaten       = 0x04,
+        PacmanCaught     = 0x08,
+        RoundCleared     = 0x10
+    };
+
+    GameCore();
+
+    // The maze is as wide as its longest line and as high as its line count
+    bool loadMaze(const QString &filename);
+    // Every random decision in a round comes from 'seed', so the same seed
+    // and the same inputs replay the round exactly.
+    bool startRound(int round, bool resetScore, quint64 seed);
+
+    // Advance the simulation by one tick. 'input' is the direction requested
+    // since the last tick (Stop for none); it is ignored while Pac-Man is
+    // still moving between cells. Returns a mask of Event flags.
+    int step(Direction input);
+
+    // Times step() and its hot parts into 'profiler' (nullptr: no timing).
+    // Only the thread that calls step() may record into it.
+    void setProfiler(Profiler *profiler) { m_profiler = profiler; }
+
+    // Everything that changes during a round (not the loaded maze or path
+    // table), so a replay can jump to a keyframe instead of tick 0.
+    QByteArray saveState() const;
+    bool restoreState(const QByteArray &state);
+
+    Status status() const { return m_status; }
+    int score() const { return m_score; }
+    int pelletsEaten() const { return m_pelletsEaten; }
+    int pelletsLeft() const { return m_pelletsLeft; }           // Regular pellets still in the maze
+    int powerPelletsLeft() const { return m_powerPelletsLeft; }
+    int round() const { return m_round; }
+    quint64 tick() const { return m_tick; }
+    quint64 seed() const { return m_seed; }
+    QString mazeFile() const { return m_mazeFile; }
+    bool hasStartPosition() const { return startMacroRow != -1 && startMacroCol != -1; }
+
+    int mazeWidth() const { return m_maze.width(); }
+    int mazeHeight() const { return m_maze.height(); }
+    int cellAt(int row, int col) const { return m_maze.cellValue(col, row); }
+    const MazeBits &maze() const { return m_maze; }
+    CellInfo cellInfo(int col, int row) const { return m_cellInfo[row * mazeWidth() + col]; }
+    bool usesClusterPaths() const { return !m_clusterPaths.isEmpty(); }
+
+    QPoint pacmanCenter() const { return pacman_grid_center; }
+    QPoint pacmanCell() const { return pacman_macrogrid_center; }
+    Direction pacmanDirection() const { return m_pacmanDirection; }
+    int pacmanMouthAngle() const { return m_pacmanMouthAngle; }
+    bool isPacmanMoving() const { return isMoving; }
+    bool canMove(int tx, int ty) const;
+
+    QVector<Ghost> ghostList() const; // Live ghosts in slot order
+    const GhostPool &ghostPool() const { return m_ghosts; }
+    int ghostCount() const { return m_ghosts.count(); }
+    int caughtByType() const { return m_caughtByType; } // GhostType, or -1 while alive
+    static Color getGhostColor(const Ghost &ghost); // By type, outside panic
+
+    static QPoint macroGridToGridCenter(int macroCol, int macroRow);
+    QPoint gridToMacroGrid(int gridX, int gridY) const;
+
+private:
+    // Pac-Man
+    void applyInput(Direction input);
+    void startAnimatedMove(int tx, int ty);
+    void animationStep();
+    void collectPellet();
+    bool checkAllPelletsCollected();
+    void countPellets();
+
+    // Panic / timers
+    enum TimerKind {
+        PanicTimeout,
+        GhostRespawn
+    };
+    void activatePanicMode();
+    void panicModeTimeout();
+    void updateTimers();
+    int ticksLeft(TimerHandle timer) const; // As the snapshot counts them, 0 if not pending
+
+    // Ghosts
+    void ghostAnimationStep();
+    void checkGhostCollisions();
+    void initializeGhosts();
+    void clearGhosts();
+    GhostHandle addGhost(const Ghost &ghost);
+    void initializeGhost(Ghost &ghost, int spawnIndex, GhostType type);
+    void respawnGhost(int slot);
+    void spawnChildGhost(int parentSlot);
+    void moveGhost(int slot);
+    Direction getGhostDirection(Ghost &ghost);
+    Direction getGhostChaseDirection(Ghost &ghost);
+    Direction getAggressiveChaserDirection(Ghost &ghost);
+    Direction getAmbusherDirection(Ghost &ghost);
+    Direction getRandomPatrolDirection(Ghost &ghost);
+    Direction getIntersectionRandomDirection(Ghost &ghost);
+    Direction getGhostPanicDirection(Ghost &ghost);
+    bool canGhostMove(const Ghost &ghost, Direction dir);
+    bool isAtIntersection(const Ghost &ghost);
+    quint8 ghostExits(const Ghost &ghost) const;
+    Direction randomExit(quint8 exits);
+
+    // Pathfinding
+    void precomputePaths();
+    Direction pathDirection(QPoint fromCell, QPoint toCell) const;
+
+    TimingHistogram *profile(Profiler::Metric metric) const
+    {
+        return m_profiler ? &m_profiler->histogram(metric) : nullptr;
+    }
+
+    Status m_status;
+    int m_events;
+    int m_score;
+    int m_pelletsEaten;
+    int m_pelletsLeft;      // Kept up to date on every eat, so the win
+    int m_powerPelletsLeft; // check never has to scan the maze
+    int m_caughtByType;
+    int m_round;
+    quint64 m_tick;
+    quint64 m_seed;
+    GameRng m_rng;
+
+    // Maze
+    QString m_mazeFile;
+    MazeBits m_maze;             // Working maze: pellets disappear as they are eaten
+    MazeBits m_originalMaze;     // As loaded; copied back at the start of a round
+    QVector<CellInfo> m_cellInfo; // Walls never change in a game, so neither does this
+    int m_mazePellets;           // Pellet counts of m_originalMaze
+    int m_mazePowerPellets;
+    int startMacroRow;
+    int startMacroCol;
+    QVector<QPoint> ghostSpawnPositions;
+
+    // Pac-Man
+    QPoint pacman_grid_center;
+    QPoint pacman_macrogrid_center;
+    Direction m_pacmanDirection;
+    int m_pacmanMouthAngle;
+    int m_pacmanMouthDirection;
+    int m_pacmanAnimationCounter;
+    bool isMoving;
+    int moveSteps;
+    int currentStep;
+    int targetX;
+    int targetY;
+    int stepDeltaX;
+    int stepDeltaY;
+
+    // Ghosts
+    GhostPool m_ghosts;
+    TileIndex m_ghostTiles; // Pixel-center tile of every ghost, for checkGhostCollisions()
+    int nextGhostId;
+
+    // Timed events, on the game tick
+    TickScheduler m_timers;
+    TimerHandle m_panicTimer;
+    TimerHandle m_respawnTimers[MAX_GHOSTS]; // Per ghost slot
+
+    // Next-move lookups: the all-pairs table when it fits in
+    // PATH_TABLE_MAX_BYTES, the cluster/portal search otherwise
+    PathTable m_paths;
+    ClusterPaths m_clusterPaths;
+
+    Profiler *m_profiler;
+};
+
+#endif // GAMECORE_H
@@ -0,0 +1,56 @@
+#ifndef GAMERNG_H
+#define GAMERNG_H
+
+#include <QtGlobal>
+
+// Small, fast and fully reproducible generator (xoshiro256**), owned by
+// each game so runs can be replayed from their seed and parallel games
+// never contend on a shared generator.
+class GameRng
+{
+public:
+    explicit GameRng(quint64 seed = 0) { reseed(seed); }
+
+    void reseed(quint64 seed)
+    {
+        // Expand the 64-bit seed with splitmix64 so that nearby seeds
+        // (0, 1, 2...) still give unrelated streams
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9e3779b97f4a7c15ull;
+            quint64 z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    quint64 next()
+    {
+        const quint64 result = rotl(s[1] * 5, 7) * 9;
+        const quint64 t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, highest), same contract as QRandomGenerator::bounded()
+    int bounded(int highest)
+    {
+        return int(((next() >> 32) * quint64(highest)) >> 32);
+    }
+
+    // Full generator state, for game snapshots
+    quint64 state(int i) const { return s[i]; }
+    void setState(int i, quint64 value) { s[i] = value; }
+
+private:
+    static quint64 rotl(quint64 x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    quint64 s[4];
+};
+
+#endif // GAMERNG_H
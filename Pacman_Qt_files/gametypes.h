@@ -0,0 +1,51 @@
+#ifndef GAMETYPES_H
+#define GAMETYPES_H
+
+#include <QPoint>
+
+#define TILE_SIZE 32
+#define MAZE_MAX_SIDE 4096 // Mazes are sized by their map file, up to this many cells a side
+
+#define MOVESTEPS 6
+#define FRAMETIME 40
+#define REPRODUCTION_PROB 5
+#define MAX_GHOSTS 13
+
+// Timed effects are counted in simulation ticks so they stay in step with the
+// game clock (and work headless) instead of running on wall-clock QTimers.
+#define PANIC_TICKS (10000 / FRAMETIME)
+#define RESPAWN_TICKS (2000 / FRAMETIME)
+
+enum Direction { Up, Down, Left, Right, Stop };
+
+enum GhostType { Original, AggressiveChaser, Ambusher, RandomPatrol, IntersectionRandom };
+
+enum GhostMode { Chase, Panic };
+
+struct Color {
+    int r;
+    int g;
+    int b;
+};
+
+struct Ghost {
+    QPoint grid_center;      // Pixel center
+    QPoint macrogrid_center; // Maze cell (col, row)
+    GhostType type;
+    GhostMode mode;
+    Direction direction;
+    Color color;
+    bool active;
+    bool moving;
+    bool respawning;
+    int moveSteps;
+    int currentStep;
+    int stepDeltaX;
+    int stepDeltaY;
+    int failCounter;
+    float speedMultiplier;
+    int delayCounter;
+    int parentId;
+};
+
+#endif // GAMETYPES_H
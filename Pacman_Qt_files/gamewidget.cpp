@@ -1,35 +1,40 @@
 #include "gamewidget.h"
+#include "scaledpixmap.h"
 #include <QPainter>
-#include <QPainterPath>
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
+#include <QDateTime>
+#include <QDir>
 #include <QRandomGenerator>
-#include <cmath>
+#include <QStandardPaths>
 #include <QMouseEvent>
+#include <QPixmapCache>
+#include <QScreen>
 #include <QUrl>
 
-#define MOVESTEPS 6
-#define FRAMETIME 40
-#define REPRODUCTION_PROB 5
-#define MAX_GHOSTS 13
+// Full-screen images, decoded the first time their screen comes up
+#define INTRO_SCREEN     ":/assets/intro_screen.png"
+#define WIN_SCREEN       ":/assets/win.png"
+#define GAME_OVER_SCREEN ":/assets/game_over_screen.png"
+
 // === CONSTRUCTOR ===
 GameWidget::GameWidget(QWidget *parent)
     : QWidget(parent),
+    m_showProfiler(false),
     m_gameState(Menu),
-    m_score(0),
     m_round(1), // <-- Default start round
-    m_pacmanMouthAngle(10),       // Start with mouth slightly open
-    m_pacmanMouthDirection(1),    // Mouth will open
-    m_pacmanAnimationCounter(0),
-    m_pacmanDirection(Right),
-    startMacroRow(-1),
-    startMacroCol(-1), // 8 animation steps per tile
-    isMoving(false),
-    moveSteps(MOVESTEPS),
-    currentStep(0),
-    nextGhostId(0),
+    m_frameTimerId(0),
+    m_frameIntervalNs(0),
+    m_frameAlpha(1.0),
+    m_drawnZoom(0.0f),
+    m_drawnPelletsLeft(-1),
+    m_hudRound(0),
+    m_hudColorIdx(-1),
+    m_hudPixelated(false),
+    m_pelletCountValue(-1),
     m_isPixelatedMode(false),
+    m_firstPaintDone(false),
     tcpServer(nullptr),
     clientSocket(nullptr)
 {
@@ -37,8 +42,8 @@ GameWidget::GameWidget(QWidget *parent)
     // Set the window size based on our tile grid
     const int BOTTOM_BAR_HEIGHT = 60;
     setFixedSize(
-        LEFT_SIDEBAR_WIDTH + MAZE_WIDTH * TILE_SIZE + RIGHT_SIDEBAR_WIDTH,
-        MAZE_HEIGHT * TILE_SIZE + BOTTOM_BAR_HEIGHT
+        LEFT_SIDEBAR_WIDTH + VIEW_COLS * TILE_SIZE + RIGHT_SIDEBAR_WIDTH,
+        VIEW_ROWS * TILE_SIZE + BOTTOM_BAR_HEIGHT
         );
 
 
@@ -64,20 +69,24 @@ GameWidget::GameWidget(QWidget *parent)
     m_winSidebarBtnRect = QRect(winBtnX, winBtnY, btnWidth, btnHeight);
 
 
-    // Load all sprites from the resource file
-    loadAssets();
+    // Screens and tiles are drawn from copies pre-scaled to the screen
+    QPixmapCache::setCacheLimit(SCALED_PIXMAP_BUDGET_KB);
 
-    // Load intro and game over images
-    m_introImage.load(":/assets/intro_screen.png");
-    m_gameOverImage.load(":/assets/game_over_screen.png");
+    // Decode in the background so the window shows at once: the menu's
+    // screen first, then the tiles of both modes, so picking one rarely
+    // waits. Repaint whatever comes in; it may be on screen.
+    connect(&m_assets, &AssetManager::ready, this, [this]() { update(); });
+    m_assets.request(INTRO_SCREEN);
+    for (const char *tile : {"wall", "pellet", "power_pellet", "empty"}) {
+        m_assets.request(QString(":/assets/%1.png").arg(tile));
+        m_assets.request(QString(":/assets/pixel_%1.png").arg(tile));
+    }
 
     // Initialize Try Again button for GameOver state
     int tryAgainWidth = 220;
     int tryAgainHeight = 50;
     int centerX = width() / 2;
     m_tryAgainButtonRect = QRect(centerX - (tryAgainWidth / 2), height() - 100, tryAgainWidth, tryAgainHeight);
-    // Load win image
-    m_winImage.load(":/assets/win.jpg");
 
     // Initialize Next Round button for Win state
     int nextRoundWidth = 220;
@@ -104,6 +113,7 @@ GameWidget::GameWidget(QWidget *parent)
         QColor(139,69,19)     // brown
     };
     m_pacmanColorIdx = 0;
+    m_spriteAtlas.setPacmanColors(m_colorBtnColors);
 
     // Calculate bottom bar button rects (outside frame)
     int barHeight = 60;
@@ -120,18 +130,39 @@ GameWidget::GameWidget(QWidget *parent)
         m_colorBtnRects.append(rect);
     }
 
+    // Zoom buttons, centered in the right sidebar
+    int uiPaneStart = LEFT_SIDEBAR_WIDTH + VIEW_COLS * TILE_SIZE;
+    int btnMargin = 16;
+    int btnSize = 38;
+    m_zoomInRect = QRect(uiPaneStart + btnMargin, height()/2 - btnSize - 8, btnSize, btnSize);
+    m_zoomOutRect = QRect(uiPaneStart + btnMargin, height()/2 + 8, btnSize, btnSize);
+
+    // HUD fonts and labels, laid out once instead of every frame
+    m_hudButtonFont = QFont("Arial", 18, QFont::Bold);
+    m_hudSmallFont = QFont("Arial", 12, QFont::Bold);
+    for (int i = 0; i < btnCount; ++i) {
+        m_roundLabels.append(QStaticText(QString::number(i + 1)));
+        m_roundLabels[i].prepare(QTransform(), m_hudButtonFont);
+    }
+    m_plusLabel.setText("+");
+    m_plusLabel.prepare(QTransform(), m_hudButtonFont);
+    m_minusLabel.setText("-");
+    m_minusLabel.prepare(QTransform(), m_hudButtonFont);
+    m_winLabel.setText("Win");
+    m_winLabel.prepare(QTransform(), m_hudSmallFont);
+    m_pelletCountRect = pelletCounterRect().adjusted(0, QFontMetrics(m_hudSmallFont).lineSpacing(), 0, 0);
 
+    // Profiler overlay (F3), under the zoom buttons
+    m_profilerFont = QFont("Arial", 9);
+    m_profilerRect = QRect(uiPaneStart + 4, m_zoomOutRect.bottom() + 24, RIGHT_SIDEBAR_WIDTH - 8,
+                           VIEW_ROWS * TILE_SIZE - m_zoomOutRect.bottom() - 24);
 
-    // Load the maze map from resources
-    loadMaze(":/assets/map.txt");
 
-    // Porting your panic timer
-    panicTimer = new QTimer(this);
-    panicTimer->setSingleShot(true);
-    connect(panicTimer, &QTimer::timeout, this, &GameWidget::panicModeTimeout);
 
-    // Start the main game loop timer (ticks every ~33ms)
-    m_gameTimerId = startTimer(FRAMETIME);
+    // Load the maze map from resources
+    m_sim.start();
+    m_sim.setProfiler(&m_profiler);
+    m_sim.loadMaze(":/assets/map.txt");
 
     setFocusPolicy(Qt::StrongFocus);
 
@@ -187,10 +218,24 @@ GameWidget::GameWidget(QWidget *parent)
     m_gameOverSfx->setSource(QUrl("qrc:/assets/game_over.wav"));
     // =================================
     initializeSocketServer();
+
+    m_assets.mark("Window constructed");
 }
 
 GameWidget::~GameWidget()
 {
+    // End of the session: keep its timings for comparing machines. The
+    // game stops first, so no tick lands in the file half-counted.
+    m_sim.stop();
+    if (m_profiler.histogram(Profiler::Paint).count() > 0) {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/profiles";
+        QDir().mkpath(dir);
+        QString path = QString("%1/profile-%2.csv").arg(dir, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+        if (m_profiler.writeCsv(path)) {
+            qDebug() << "Timings written to" << path;
+        }
+    }
+
     // Clean up socket connections
     if (clientSocket) {
         clientSocket->close();
@@ -204,24 +249,21 @@ GameWidget::~GameWidget()
 }
 
 
+// Picks the tiles for the current mode. They were requested at startup
+// and stay decoded, so this only waits if they are not in yet.
 void GameWidget::loadAssets()
 {
+    const QString prefix = m_isPixelatedMode ? ":/assets/pixel_" : ":/assets/";
+    m_wallSprite = m_assets.waitForPixmap(prefix + "wall.png");
+    m_pelletSprite = m_assets.waitForPixmap(prefix + "pellet.png");
+    m_powerPelletSprite = m_assets.waitForPixmap(prefix + "power_pellet.png");
+    m_emptySprite = m_assets.waitForPixmap(prefix + "empty.png");
     if (m_isPixelatedMode) {
-        m_wallSprite.load(":/assets/pixel_wall.png");
-        m_pelletSprite.load(":/assets/pixel_pellet.png");
-        m_powerPelletSprite.load(":/assets/pixel_power_pellet.png");
-        m_emptySprite.load(":/assets/pixel_empty.png");
+        m_pixelFrame.setSprites(m_emptySprite, m_pelletSprite, m_powerPelletSprite);
     } else {
-        m_wallSprite.load(":/assets/wall.png");
-        m_pelletSprite.load(":/assets/pellet.png");
-        m_powerPelletSprite.load(":/assets/power_pellet.png");
-        m_emptySprite.load(":/assets/empty.png");
+        m_mazeLayer.setSprites(m_emptySprite, m_wallSprite, m_pelletSprite, m_powerPelletSprite);
     }
-
-    // Load intro and game over images
-    m_introImage.load(":/assets/intro_screen.png");
-    m_winImage.load(":/assets/win.png");
-    m_gameOverImage.load(":/assets/game_over_screen.png");
+    m_spriteAtlas.setPixelated(m_isPixelatedMode);
 }
 
 
@@ -229,30 +271,55 @@ void GameWidget::loadAssets()
 
 void GameWidget::timerEvent(QTimerEvent *event)
 {
-    if (event->timerId() == m_gameTimerId) {
-        switch (m_gameState) {
-        case Menu:
-            // No update needed
-            break;
-        case Playing:
-            updateGame(); // Run all game logic
-            break;
-        case Win:
-            // No update needed
-            break;
-        case GameOver:
-            // No update needed
-            break;
+    if (event->timerId() == m_frameTimerId) {
+        // The game runs on m_sim; pick up whatever it has done since
+        if (m_sim.fetchSnapshot()) {
+            handleSnapshot();
         }
 
-        // Tell Qt to redraw the screen. This will call paintEvent().
-        update();
+        if (m_gameState != Playing) {
+            // The game just ended. Draw its screen once, then sleep: static
+            // screens only change on input, which repaints them itself.
+            killTimer(m_frameTimerId);
+            m_frameTimerId = 0;
+            update();
+            return;
+        }
+
+        // Late wake-ups are dropped frames
+        if (m_frameClock.isValid()) {
+            m_profiler.frameShown(m_frameClock.nsecsElapsed(), m_frameIntervalNs);
+        }
+        m_frameClock.start();
+
+        const qint64 tickNs = qint64(FRAMETIME) * 1000000;
+        m_frameAlpha = qBound<qreal>(0.0, qreal(m_sim.clockNs() - m_sim.snapshot().simTimeNs) / tickNs, 1.0);
+
+        // Redraw only what moved or changed. This will call paintEvent().
+        update(damagedRegion());
     }
 }
 
+// Runs the frame loop at the display's refresh rate while a game is on; the
+// game itself ticks every FRAMETIME ms on the simulation thread
+void GameWidget::startFrameLoop()
+{
+    if (m_frameTimerId == 0) {
+        int frameInterval = qMax(1, qRound(1000.0 / screen()->refreshRate()));
+        m_frameTimerId = startTimer(frameInterval, Qt::PreciseTimer);
+        m_frameIntervalNs = qint64(frameInterval) * 1000000;
+        m_frameClock.invalidate(); // The pause before this is no dropped frame
+    }
+    update();
+}
+
 void GameWidget::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    if (!m_firstPaintDone) {
+        m_firstPaintDone = true;
+        m_assets.mark("First paint");
+    }
+
     QPainter painter(this);
 
     // --- DYNAMIC RENDER HINT ---
@@ -271,7 +338,7 @@ void GameWidget::paintEvent(QPaintEvent *event)
         drawMenu(painter);
         break;
     case Playing:
-        drawGame(painter);
+        drawGame(painter, event->region());
         break;
     case Win:
         drawWin(painter);
@@ -320,6 +387,7 @@ void GameWidget::onClientDisconnected()
 void GameWidget::onReadyRead()
 {
     if (!clientSocket) return;
+    ProfileScope socketScope(&m_profiler.histogram(Profiler::Socket));
 
     QByteArray data = clientSocket->readAll();
     QString command = QString::fromUtf8(data).trimmed();
@@ -332,7 +400,7 @@ void GameWidget::onReadyRead()
 void GameWidget::processMovementCommand(const QString &command)
 {
     // FIXED: Check if game is NOT Playing
-    if (m_gameState != Playing || isMoving) {
+    if (m_gameState != Playing || m_sim.snapshot().pacmanMoving) {
         return; // Ignore commands if game not playing or already moving
     }
 
@@ -341,61 +409,61 @@ void GameWidget::processMovementCommand(const QString &command)
         return;
     }
 
-    // Process single direction commands
+    // Process single direction commands (applied by GameCore on the next tick)
     if (command == "Up") {
-        if (canMove(0, -1)) {  // FIXED: Should be -1, not 7
-            m_pacmanDirection = Up;
-            startAnimatedMove(0, -TILE_SIZE);  // FIXED: Use TILE_SIZE, not 7
-        }
+        queueInput(Up, HeadPoseInput);
     } else if (command == "Down") {
-        if (canMove(0, 1)) {  // FIXED: Should be 1, not -7
-            m_pacmanDirection = Down;
-            startAnimatedMove(0, TILE_SIZE);  // FIXED: Use TILE_SIZE, not -7
-        }
+        queueInput(Down, HeadPoseInput);
     } else if (command == "Left") {
-        if (canMove(-1, 0)) {  // FIXED: Should be -1, not -7
-            m_pacmanDirection = Left;
-            startAnimatedMove(-TILE_SIZE, 0);  // FIXED: Use -TILE_SIZE, not -7
-        }
+        queueInput(Left, HeadPoseInput);
     } else if (command == "Right") {
-        if (canMove(1, 0)) {  // FIXED: Should be 1, not 7
-            m_pacmanDirection = Right;
-            startAnimatedMove(TILE_SIZE, 0);  // FIXED: Use TILE_SIZE, not 7
-        }
+        queueInput(Right, HeadPoseInput);
     }
 }
 
+void GameWidget::queueInput(Direction dir, InputSource source)
+{
+    if (m_sim.snapshot().replaying) return; // Replays only follow the recorded input
+
+    m_sim.setInput(dir, source);
+}
+
 void GameWidget::keyPressEvent(QKeyEvent *event)
 {
+    // F3 shows or hides the timings in the right sidebar
+    if (event->key() == Qt::Key_F3) {
+        m_showProfiler = !m_showProfiler;
+        m_profilerRefresh.invalidate();
+        updateProfilerText();
+        update();
+        return;
+    }
+
+    // PageUp/PageDown skip 10 seconds through a replay
+    if (m_sim.snapshot().replaying && (event->key() == Qt::Key_PageUp || event->key() == Qt::Key_PageDown)) {
+        m_sim.seekReplay(event->key() == Qt::Key_PageDown ? SESSION_KEYFRAME_INTERVAL : -SESSION_KEYFRAME_INTERVAL);
+        m_gameState = Playing;
+        startFrameLoop();
+        return;
+    }
+
     // FIXED: Check if game is NOT Playing
-    if (m_gameState != Playing || isMoving) {
+    if (m_gameState != Playing || m_sim.snapshot().pacmanMoving) {
         return;
     }
 
     switch (event->key()) {
     case Qt::Key_Up:
-        if (canMove(0, -1)) {  // FIXED: macro grid delta
-            m_pacmanDirection = Up;
-            startAnimatedMove(0, -TILE_SIZE);  // FIXED: pixel delta
-        }
+        queueInput(Up, KeyboardInput);
         break;
     case Qt::Key_Down:
-        if (canMove(0, 1)) {  // FIXED
-            m_pacmanDirection = Down;
-            startAnimatedMove(0, TILE_SIZE);  // FIXED
-        }
+        queueInput(Down, KeyboardInput);
         break;
     case Qt::Key_Left:
-        if (canMove(-1, 0)) {  // FIXED
-            m_pacmanDirection = Left;
-            startAnimatedMove(-TILE_SIZE, 0);  // FIXED
-        }
+        queueInput(Left, KeyboardInput);
         break;
     case Qt::Key_Right:
-        if (canMove(1, 0)) {  // FIXED
-            m_pacmanDirection = Right;
-            startAnimatedMove(TILE_SIZE, 0);  // FIXED
-        }
+        queueInput(Right, KeyboardInput);
         break;
     default:
         QWidget::keyPressEvent(event);
@@ -442,6 +510,7 @@ void GameWidget::mousePressEvent(QMouseEvent *event)
 
     // Win sidebar button: transition to Win state (show Win screen)
     if (m_winSidebarBtnRect.contains(event->pos())) {
+        m_sim.pause();
         m_gameState = Win;
         update();
         return;
@@ -486,29 +555,37 @@ void GameWidget::mousePressEvent(QMouseEvent *event)
 
 // === STATE-SPECIFIC UPDATE FUNCTIONS ===
 
-void GameWidget::updateGame()
+// Plays the sounds and makes the state changes for everything the game
+// reported since the last snapshot
+void GameWidget::handleSnapshot()
 {
-    // 1. Run Pac-Man's animation (if he's moving)
-    if (isMoving) {
-        animationStep();
-
-        // Animate Pac-Man's mouth
-        m_pacmanAnimationCounter++;
-        if (m_pacmanAnimationCounter > 2) { // Change every 3 frames
-            m_pacmanAnimationCounter = 0;
-            m_pacmanMouthAngle += m_pacmanMouthDirection * 15;
-            // Reverse direction if mouth is fully open or closed
-            if (m_pacmanMouthAngle >= 45 || m_pacmanMouthAngle <= 0) {
-                m_pacmanMouthDirection *= -1;
-            }
-        }
+    if (m_gameState != Playing) {
+        return; // The player has already left this game
     }
 
-    // 2. Run the Ghost's animation/AI step
-    ghostAnimationStep();
+    const GameSnapshot &snapshot = m_sim.snapshot();
+    const int events = snapshot.events;
+    if (events & GameCore::PelletEaten) {
+        m_pelletSfx->play();
+    }
+    if (events & GameCore::PowerPelletEaten) {
+        m_powerPelletSfx->play();
+    }
+    if (events & GameCore::RoundCleared) {
+        resetLevel();
+    }
+    if (events & GameCore::PacmanCaught) {
+        m_gameState = GameOver;
+        m_bgMusicPlayer->stop();
+        m_gameOverSfx->play();
+    }
 
-    // 3. Check for collisions
-    checkGhostCollisions();
+    if (snapshot.replayEnded && m_gameState == Playing) {
+        // End of the recording: hold the last frame
+        m_gameState = (snapshot.status == GameCore::Won) ? Win
+                      : (snapshot.status == GameCore::Lost) ? GameOver : Playing;
+        m_bgMusicPlayer->stop();
+    }
 }
 
 
@@ -519,9 +596,9 @@ void GameWidget::drawMenu(QPainter &painter)
     painter.fillRect(rect(), Qt::black);
 
     // Draw the new intro image scaled to fit frame
-    if (!m_introImage.isNull()) {
-        QRect imageRect = rect();
-        painter.drawPixmap(imageRect, m_introImage);
+    const QPixmap intro = m_assets.pixmap(INTRO_SCREEN);
+    if (!intro.isNull()) {
+        painter.drawPixmap(0, 0, background(intro));
     }
 
     // Placement parameters for bottom alignment
@@ -598,9 +675,9 @@ void GameWidget::drawWin(QPainter &painter)
     painter.fillRect(rect(), Qt::black);
 
     // Draw the win image scaled to fit the frame
-    if (!m_winImage.isNull()) {
-        QRect imageRect = rect();
-        painter.drawPixmap(imageRect, m_winImage);
+    const QPixmap win = m_assets.pixmap(WIN_SCREEN);
+    if (!win.isNull()) {
+        painter.drawPixmap(0, 0, background(win));
     }
 
     // Display the score at the top-center area
@@ -608,7 +685,7 @@ void GameWidget::drawWin(QPainter &painter)
     QFont scoreFont("Arial", 32, QFont::Bold);
     painter.setFont(scoreFont);
     QRect scoreRect = rect().adjusted(0, 80, 0, 0);
-    painter.drawText(scoreRect, Qt::AlignHCenter | Qt::AlignTop, QString("Score: %1").arg(m_score));
+    painter.drawText(scoreRect, Qt::AlignHCenter | Qt::AlignTop, QString("Score: %1").arg(m_sim.snapshot().score));
 
     // Calculate Next Round button position - bottom aligned
     int buttonWidth = 220;
@@ -628,72 +705,109 @@ void GameWidget::drawWin(QPainter &painter)
 }
 
 
-void GameWidget::drawGame(QPainter &painter)
+void GameWidget::drawGame(QPainter &painter, const QRegion &dirty)
 {
-    // Fill entire widget
-    painter.fillRect(rect(), Qt::black);
-
-    // --- Draw game field offset by LEFT_SIDEBAR_WIDTH ---
-    painter.save();
-    painter.translate(LEFT_SIDEBAR_WIDTH, 0); // Offset for left sidebar
-    painter.scale(m_zoomFactor, m_zoomFactor);
-
-    // Draw maze, Pac-Man, ghosts, pellets, etc...
-    for (int row = 0; row < MAZE_HEIGHT; row++) {
-        for (int col = 0; col < MAZE_WIDTH; col++) {
-            int x = col * TILE_SIZE;
-            int y = row * TILE_SIZE;
-
-            painter.drawPixmap(x, y, m_emptySprite);
-
-            if (mazeGrid[row][col] == 1) {
-                if (m_isPixelatedMode) {
-                    painter.setBrush(QColor(0, 0, 255));
-                    painter.setPen(Qt::NoPen);
-                    painter.drawRect(x, y, TILE_SIZE, TILE_SIZE);
-                } else {
-                    painter.drawPixmap(x, y, m_wallSprite);
-                }
-            }
+    ProfileScope paintScope(&m_profiler.histogram(Profiler::Paint));
+
+    // Background, sidebars and colour bar in one blit
+    painter.drawPixmap(0, 0, hudLayer());
+
+    const GameSnapshot &snapshot = m_sim.snapshot();
+    const QPoint camera = cameraOrigin();
+    const QRect field(LEFT_SIDEBAR_WIDTH, 0, VIEW_COLS * TILE_SIZE, VIEW_ROWS * TILE_SIZE);
+    QSize viewSize(int(VIEW_COLS * TILE_SIZE / m_zoomFactor), int(VIEW_ROWS * TILE_SIZE / m_zoomFactor));
+
+    // Actors come from the sprite atlas, at frame resolution in pixel mode
+    m_spriteAtlas.setScale(m_isPixelatedMode ? 1.0 / PIXEL_SIZE : m_zoomFactor * devicePixelRatioF());
+    m_spriteAtlas.prepare();
+
+    if (!m_isPixelatedMode) {
+        // The maze comes pre-rendered (see MazeLayer); bring it up to date
+        // before anything draws from it
+        m_mazeLayer.setScale(m_zoomFactor * devicePixelRatioF());
+        m_mazeLayer.sync(snapshot.maze);
+        m_mazeLayer.prepare(QRect(camera, viewSize));
+
+        // HD: painted on all cores into a framebuffer, presented in one blit
+        const QImage &frame = m_fieldRenderer.render(field.size(), devicePixelRatioF(), dirty.translated(-field.topLeft()),
+                                                     [&](QPainter &tilePainter, const QRect &tile) {
+                                                         drawField(tilePainter, tile, camera);
+                                                     });
+        painter.drawImage(field.topLeft(), frame);
+    } else {
+        // Pixel mode: the whole field redrawn at a quarter of the resolution,
+        // presented in one unsmoothed blit
+        m_pixelFrame.begin(snapshot.maze, QRect(camera, viewSize));
+        m_pixelFrame.drawSprite(m_spriteAtlas.image(),
+                                m_spriteAtlas.pacmanCell(m_pacmanColorIdx, snapshot.pacmanDirection, snapshot.pacmanMouthAngle),
+                                interpolate(snapshot.pacmanPrevious, snapshot.pacmanCenter));
+        for (const GhostSprite &ghost : snapshot.ghosts) {
+            m_pixelFrame.drawSprite(m_spriteAtlas.image(), m_spriteAtlas.ghostCell(ghost.type, ghost.mode, ghost.direction),
+                                    interpolate(ghost.previous, ghost.center));
+        }
 
-            if (mazeGrid[row][col] == 0) {
-                painter.drawPixmap(x, y, m_pelletSprite);
-            }
+        // --- Draw game field offset by LEFT_SIDEBAR_WIDTH ---
+        painter.save();
+        painter.translate(field.topLeft()); // Offset for left sidebar
+        painter.setClipRect(0, 0, field.width(), field.height());
+        painter.scale(m_zoomFactor, m_zoomFactor);
+        painter.translate(-camera);
+        painter.drawImage(m_pixelFrame.target(), m_pixelFrame.image());
+        painter.restore();
+    }
 
-            if (mazeGrid[row][col] == 4) {
-                painter.drawPixmap(x, y, m_powerPelletSprite);
-            }
-        }
+    // Pellets still to eat, under their label in the HUD layer. Laid out
+    // again only when the count changes.
+    if (snapshot.pelletsLeft != m_pelletCountValue) {
+        m_pelletCountValue = snapshot.pelletsLeft;
+        m_pelletCountText.setText(QString::number(m_pelletCountValue));
     }
+    painter.setFont(m_hudSmallFont);
+    painter.setPen(Qt::yellow);
+    painter.drawStaticText(QPointF(m_pelletCountRect.x() + (m_pelletCountRect.width() - m_pelletCountText.size().width()) / 2,
+                                   m_pelletCountRect.y()),
+                           m_pelletCountText);
 
-    drawPacman(painter, pacman_grid_center, m_pacmanDirection);
+    if (m_showProfiler) {
+        painter.setFont(m_profilerFont);
+        painter.setPen(Qt::white);
+        painter.drawText(m_profilerRect, Qt::AlignLeft | Qt::AlignTop, m_profilerText);
+    }
+}
 
-    for (const Ghost &ghost : ghosts) {
-        if (ghost.active) {
-            drawGhost(painter, ghost);
-        }
+// The sidebars and the colour bar, rendered only when the round, the colour
+// or the mode changes. Opaque, so it doubles as the frame's background.
+const QPixmap &GameWidget::hudLayer()
+{
+    const qreal dpr = devicePixelRatioF();
+    if (m_hudLayer.size() == size() * dpr && m_hudRound == m_round &&
+        m_hudColorIdx == m_pacmanColorIdx && m_hudPixelated == m_isPixelatedMode) {
+        return m_hudLayer;
     }
+    m_hudRound = m_round;
+    m_hudColorIdx = m_pacmanColorIdx;
+    m_hudPixelated = m_isPixelatedMode;
 
-    painter.restore();
+    m_hudLayer = QPixmap(size() * dpr);
+    m_hudLayer.setDevicePixelRatio(dpr);
+    m_hudLayer.fill(Qt::black);
+    QPainter painter(&m_hudLayer);
+    painter.setRenderHint(QPainter::Antialiasing, !m_isPixelatedMode);
 
     // --- Draw Left Sidebar Buttons (Virtual Round Select) ---
-    if (m_gameState == Playing || m_gameState == GameOver || m_gameState == Win) {
-        QFont btnFont("Arial", 18, QFont::Bold);
-        painter.setFont(btnFont);
-
-        for (int i = 0; i < m_roundBtnRects.size(); ++i) {
-            QRect rect = m_roundBtnRects[i];
-            if (m_round == (i + 1)) {
-                painter.setBrush(Qt::yellow);
-                painter.setPen(QColor(0, 0, 255));
-            } else {
-                painter.setBrush(Qt::white);
-                painter.setPen(QColor(0, 0, 255));
-            }
-            painter.drawRect(rect);
-            painter.setPen(Qt::black);
-            painter.drawText(rect, Qt::AlignCenter, QString::number(i + 1));
+    painter.setFont(m_hudButtonFont);
+    for (int i = 0; i < m_roundBtnRects.size(); ++i) {
+        QRect rect = m_roundBtnRects[i];
+        if (m_round == (i + 1)) {
+            painter.setBrush(Qt::yellow);
+            painter.setPen(QColor(0, 0, 255));
+        } else {
+            painter.setBrush(Qt::white);
+            painter.setPen(QColor(0, 0, 255));
         }
+        painter.drawRect(rect);
+        painter.setPen(Qt::black);
+        drawCenteredText(painter, rect, m_roundLabels[i]);
     }
 
     // Draw Win Button at top of left sidebar
@@ -701,1116 +815,308 @@ void GameWidget::drawGame(QPainter &painter)
     painter.setBrush(Qt::green);
     painter.drawRect(m_winSidebarBtnRect);
     painter.setPen(Qt::black);
-    QFont winFont("Arial", 12, QFont::Bold);
-    painter.setFont(winFont);
-    painter.drawText(m_winSidebarBtnRect, Qt::AlignCenter, "Win");
-
-
-    // --- Draw Right Sidebar (Zoom Buttons - unchanged) ---
-    int uiPaneStart = LEFT_SIDEBAR_WIDTH + MAZE_WIDTH * TILE_SIZE;
-    int btnMargin = 16;
-    int btnSize = 38;
-
-    m_zoomInRect = QRect(uiPaneStart + btnMargin, height()/2 - btnSize - 8, btnSize, btnSize);
-    m_zoomOutRect = QRect(uiPaneStart + btnMargin, height()/2 + 8, btnSize, btnSize);
+    painter.setFont(m_hudSmallFont);
+    drawCenteredText(painter, m_winSidebarBtnRect, m_winLabel);
 
+    // --- Draw Right Sidebar (Zoom Buttons) ---
     painter.setPen(QColor(0, 0, 255));
     painter.setBrush(Qt::white);
     painter.drawRect(m_zoomInRect);
     painter.drawRect(m_zoomOutRect);
 
-    QFont zoomFont("Arial", 18, QFont::Bold);
-    painter.setFont(zoomFont);
+    painter.setFont(m_hudButtonFont);
     painter.setPen(Qt::black);
-    painter.drawText(m_zoomInRect, Qt::AlignCenter, "+");
-    painter.drawText(m_zoomOutRect, Qt::AlignCenter, "-");
+    drawCenteredText(painter, m_zoomInRect, m_plusLabel);
+    drawCenteredText(painter, m_zoomOutRect, m_minusLabel);
+
+    // Label of the pellet count drawn over this every frame
+    painter.setFont(m_hudSmallFont);
+    painter.setPen(Qt::yellow);
+    painter.drawText(pelletCounterRect(), Qt::AlignHCenter | Qt::AlignTop, "Pellets");
 
     // Draw bottom bar/buttons - exclude from zoom/translation!
-    if (m_gameState == Playing) {
-        for (int i = 0; i < 12; ++i) {
-            QRect rect = m_colorBtnRects[i];
-            painter.setPen(Qt::black);
-            painter.setBrush(m_colorBtnColors[i]);
-            painter.drawRect(rect);
-            if (i == m_pacmanColorIdx) {
-                painter.setPen(QPen(Qt::white, 4));
-                painter.drawRect(rect.adjusted(-2,-2,2,2));
-            }
+    for (int i = 0; i < 12; ++i) {
+        QRect rect = m_colorBtnRects[i];
+        painter.setPen(Qt::black);
+        painter.setBrush(m_colorBtnColors[i]);
+        painter.drawRect(rect);
+        if (i == m_pacmanColorIdx) {
+            painter.setPen(QPen(Qt::white, 4));
+            painter.drawRect(rect.adjusted(-2,-2,2,2));
         }
     }
-
-
+    return m_hudLayer;
 }
 
-void GameWidget::drawGameOver(QPainter &painter)
+void GameWidget::drawCenteredText(QPainter &painter, const QRect &rect, const QStaticText &text)
 {
-    painter.fillRect(rect(), Qt::black);
-
-    // Draw the game over image scaled to fit the frame
-    if (!m_gameOverImage.isNull()) {
-        QRect imageRect = rect();
-        painter.drawPixmap(imageRect, m_gameOverImage);
-    }
-
-    // Display the score at the top-center area
-    painter.setPen(Qt::yellow);
-    QFont scoreFont("Arial", 32, QFont::Bold);
-    painter.setFont(scoreFont);
-    QRect scoreRect = rect().adjusted(0, 80, 0, 0);
-    painter.drawText(scoreRect, Qt::AlignHCenter | Qt::AlignTop, QString("Score: %1").arg(m_score));
-
-    // Calculate Try Again button position - bottom aligned
-    int buttonWidth = 220;
-    int buttonHeight = 50;
-    int centerX = width() / 2;
-    int bottomMargin = 80;
-    m_tryAgainButtonRect = QRect(centerX - (buttonWidth / 2), height() - bottomMargin, buttonWidth, buttonHeight);
-
-    // Draw Try Again button
-    painter.setPen(QColor(0, 0, 255));
-    painter.setBrush(Qt::yellow);
-    painter.drawRect(m_tryAgainButtonRect);
-    painter.setPen(Qt::black);
-    QFont btnFont("Arial", 24, QFont::Bold);
-    painter.setFont(btnFont);
-    painter.drawText(m_tryAgainButtonRect, Qt::AlignCenter, "TRY AGAIN");
+    const QSizeF size = text.size();
+    painter.drawStaticText(QPointF(rect.x() + (rect.width() - size.width()) / 2,
+                                   rect.y() + (rect.height() - size.height()) / 2), text);
 }
 
-void GameWidget::drawPacman(QPainter &painter, QPoint center, Direction dir)
+// Widget area that changed since the last frame: the actors where they
+// were and where they are now, eaten pellets and the pellet counter. A
+// camera move or zoom changes the whole field.
+QRegion GameWidget::damagedRegion()
 {
-    // === 1. SETUP: Determine drawing target and size ===
-    QPainter *drawTarget = &painter;
-    QPixmap buffer;
-    int targetSize = TILE_SIZE;
-    int bufferResolution = TILE_SIZE;
-
-    // Only use the buffer for pixelated mode
-    if (m_isPixelatedMode) {
-        // Set the internal drawing resolution (e.g., 8x8)
-        bufferResolution = TILE_SIZE / 4;
-        buffer = QPixmap(bufferResolution, bufferResolution);
-        buffer.fill(Qt::transparent); // Start with transparent background
-
-        drawTarget = new QPainter(&buffer); // Draw onto the buffer
-        drawTarget->setRenderHint(QPainter::Antialiasing, false);
-
-    }
-
-    // === 2. ACTUAL PACMAN DRAWING LOGIC (Modified to use drawTarget) ===
-    drawTarget->setPen(Qt::NoPen);
-    drawTarget->setBrush(m_colorBtnColors[m_pacmanColorIdx]);
-
-    int angle = m_pacmanMouthAngle * 16;
-    int span = (360 - m_pacmanMouthAngle * 2) * 16;
-    int startAngle = 0;
-
-    // Calculate the size and center for the target resolution (bufferResolution)
-    int radius = bufferResolution / 2;
-    QRect rect1(center.x()-bufferResolution/2,center.y()-bufferResolution/2, bufferResolution, bufferResolution);
-    QRect rect(0,0, bufferResolution, bufferResolution);
-
-    // Rotate the mouth based on direction
-    switch (dir) {
-    case Right: startAngle = angle / 2; break;
-    case Left:  startAngle = (180 * 16) + (angle / 2); break;
-    case Up:    startAngle = (90 * 16) + (angle / 2); break;
-    case Down:  startAngle = (270 * 16) + (angle / 2); break;
-    default:    startAngle = angle / 2; break;
-    }
-
-
-
-    // === 3. FINAL STEP: Draw the buffer if necessary ===
-    if (m_isPixelatedMode) {
-        drawTarget->drawPie(rect, startAngle, span);
-        delete drawTarget; // Finish painting on the buffer
-        // Draw the low-res buffer onto the main painter, scaling it up to 32x32.
-        // This scaling creates the blocky, pixelated look.
-        painter.drawPixmap(center.x() - targetSize/2, center.y() - targetSize/2, targetSize, targetSize, buffer);
+    const GameSnapshot &snapshot = m_sim.snapshot();
+    const QRect field(LEFT_SIDEBAR_WIDTH, 0, VIEW_COLS * TILE_SIZE, VIEW_ROWS * TILE_SIZE);
+    const QPoint camera = cameraOrigin();
+    const QSize tile(TILE_SIZE, TILE_SIZE);
+
+    // Pixel mode snaps actors up to PIXEL_SIZE - 1 up and left
+    auto actorRect = [](QPoint center) {
+        return QRect(center - QPoint(TILE_SIZE / 2 + PIXEL_SIZE, TILE_SIZE / 2 + PIXEL_SIZE),
+                     QSize(TILE_SIZE + PIXEL_SIZE, TILE_SIZE + PIXEL_SIZE));
+    };
+    m_frameActors.clear();
+    m_frameActors.append(actorRect(interpolate(snapshot.pacmanPrevious, snapshot.pacmanCenter)));
+    for (const GhostSprite &ghost : snapshot.ghosts) {
+        m_frameActors.append(actorRect(interpolate(ghost.previous, ghost.center)));
     }
-    else drawTarget->drawPie(rect1, startAngle, span);
-    // If not in pixelated mode, it was drawn directly to 'painter'.
-}
-
-// This function draws the ghost using an 8x8 buffer, which is then scaled up to 32x32 (TILE_SIZE),
-// forcing a blocky, low-resolution appearance.
-void GameWidget::drawPixelGhost(QPainter &painter, const Ghost &ghost)
-{
-    const int bufferScale = 4;
-    const int bufferResolution = TILE_SIZE / bufferScale; // E.g., 8x8
-    QPixmap buffer(bufferResolution, bufferResolution);
-    buffer.fill(Qt::transparent);
-    QPainter drawTarget(&buffer);
-    drawTarget.setRenderHint(QPainter::Antialiasing, false);
-
-    // Body - colored circle
-    QColor ghostCol = (ghost.mode == Panic)
-                          ? QColor(0, 100, 255)
-                          : QColor(ghost.color.r, ghost.color.g, ghost.color.b);
-    drawTarget.setBrush(ghostCol);
-    drawTarget.setPen(Qt::NoPen);
-    drawTarget.drawEllipse(buffer.rect());
-
-    // Eyes - simple white dots
-    drawTarget.setBrush(Qt::white);
-    int eyeR = bufferResolution / 6;
-    QPoint leftEye(bufferResolution / 3, bufferResolution / 3);
-    QPoint rightEye(2 * bufferResolution / 3, bufferResolution / 3);
-    drawTarget.drawEllipse(leftEye, eyeR, eyeR);
-    drawTarget.drawEllipse(rightEye, eyeR, eyeR);
-
-    // Pupils - centered black dots
-    drawTarget.setBrush(Qt::black);
-    int pupilR = bufferResolution / 12;
-    drawTarget.drawEllipse(leftEye, pupilR, pupilR);
-    drawTarget.drawEllipse(rightEye, pupilR, pupilR);
-
-    // Scale up and draw at ghost position
-    int px = ghost.grid_center.x() - TILE_SIZE / 2;
-    int py = ghost.grid_center.y() - TILE_SIZE / 2;
-    painter.drawPixmap(px, py, TILE_SIZE, TILE_SIZE, buffer);
-}
 
-
-void GameWidget::drawGhost(QPainter &painter, const Ghost &ghost)
-{
-    if (m_isPixelatedMode) {
-        drawPixelGhost(painter, ghost);
-        return;
+    QRegion region;
+    QVector<QPoint> eaten;
+    if (snapshot.maze.width() == m_drawnMaze.width() && snapshot.maze.height() == m_drawnMaze.height()) {
+        eaten = snapshot.maze.changedCells(m_drawnMaze, MazeBits::Pellets) +
+                snapshot.maze.changedCells(m_drawnMaze, MazeBits::PowerPellets);
     }
-
-    QPoint center = ghost.grid_center;
-    int r = TILE_SIZE / 2;
-
-    // Set the ghost's color based on its mode
-    if (ghost.mode == Panic) {
-        painter.setBrush(QColor(0, 100, 255)); // Blue panic color
+    if (camera != m_drawnCamera || m_zoomFactor != m_drawnZoom || eaten.size() > VIEW_COLS) {
+        region = field;
     } else {
-        // Use the color from your original logic!
-        painter.setBrush(QColor(ghost.color.r, ghost.color.g, ghost.color.b));
-    }
-    painter.setPen(Qt::NoPen);
-
-    // Use a QPainterPath to create the ghost shape
-    QPainterPath path;
-
-    // Top semi-circle
-    QRectF head(center.x() - r, center.y() - r, TILE_SIZE, TILE_SIZE);
-    path.arcMoveTo(head, 180);
-    path.arcTo(head, 180, -180); // Arc from left to right over the top
-
-    // Wavy bottom
-    int numWaves = 3;
-    float waveWidth = (float)TILE_SIZE / numWaves;
-    float waveHeight = TILE_SIZE / 6;
-
-    QPointF current = path.currentPosition(); // Should be (center.x + r, center.y)
-
-    for (int i = 0; i < numWaves; ++i) {
-        QPointF p1 = QPointF(current.x() - (waveWidth / 2.0), current.y() + waveHeight);
-        QPointF p2 = QPointF(current.x() - waveWidth, current.y());
-        path.quadTo(p1, p2);
-        current = p2;
-    }
-
-    path.closeSubpath(); // Connects back to (center.x - r, center.y)
-    painter.drawPath(path);
-
-    // --- Draw Eyes ---
-    painter.setBrush(Qt::white);
-    int eyeR = TILE_SIZE / 6;
-    QPoint leftEyeCenter(center.x() - TILE_SIZE/4, center.y() - TILE_SIZE/6);
-    QPoint rightEyeCenter(center.x() + TILE_SIZE/4, center.y() - TILE_SIZE/6);
-
-    painter.drawEllipse(leftEyeCenter, eyeR, eyeR);
-    painter.drawEllipse(rightEyeCenter, eyeR, eyeR);
-
-    if (ghost.mode == Panic)
-    {
-        // Simple scared mouth
-        painter.setPen(QPen(Qt::white, 2));
-        painter.setBrush(Qt::NoBrush);
-        QPainterPath mouth;
-        mouth.moveTo(center.x() - TILE_SIZE/4, center.y() + TILE_SIZE/4);
-        mouth.quadTo(center.x(), center.y() + TILE_SIZE/8,
-                     center.x() + TILE_SIZE/4, center.y() + TILE_SIZE/4);
-        painter.drawPath(mouth);
-    }
-    else
-    {
-        // Pupils looking in the direction of movement
-        painter.setBrush(Qt::black);
-        int pupilR = TILE_SIZE / 12;
-        QPoint pupilOffset(0,0);
-
-        switch(ghost.direction) {
-        case Left: pupilOffset.setX(-eyeR/2); break;
-        case Right: pupilOffset.setX(eyeR/2); break;
-        case Up: pupilOffset.setY(-eyeR/2); break;
-        case Down: pupilOffset.setY(eyeR/2); break;
-        default: break;
+        for (const QRect &actor : m_drawnActors) {
+            region += mazeToWidget(actor, camera) & field;
         }
-
-        painter.drawEllipse(leftEyeCenter + pupilOffset, pupilR, pupilR);
-        painter.drawEllipse(rightEyeCenter + pupilOffset, pupilR, pupilR);
-    }
-}
-
-void GameWidget::precomputePaths()
-{
-    qDebug() << "Starting path pre-computation...";
-    m_pointToId.clear();
-    m_idToPoint.clear();
-    m_nextMoveLookup.clear();
-
-    // 1. Map all valid (non-wall) points to a unique ID
-    int currentId = 0;
-    for (int r = 0; r < MAZE_HEIGHT; ++r) {
-        for (int c = 0; c < MAZE_WIDTH; ++c) {
-            // We can pathfind *from* any non-wall tile
-            if (mazeGrid[r][c] != 1) {
-                QPoint p(c, r);
-                m_pointToId[p] = currentId;
-                m_idToPoint.append(p);
-                currentId++;
-            }
+        for (const QRect &actor : m_frameActors) {
+            region += mazeToWidget(actor, camera) & field;
         }
-    }
-
-    int numValidNodes = m_idToPoint.size();
-    if (numValidNodes == 0) return;
-
-    // 2. Initialize the DP lookup table
-    // m_nextMoveLookup[startId][targetId] = nextMovePoint
-    m_nextMoveLookup.resize(numValidNodes);
-    for (int i = 0; i < numValidNodes; ++i) {
-        m_nextMoveLookup[i].resize(numValidNodes);
-    }
-
-    // 3. Run a BFS from *every* valid node to all other nodes
-    for (int i = 0; i < numValidNodes; ++i) {
-        QPoint startPoint = m_idToPoint[i];
-        int startId = i;
-
-        QPoint cameFrom[MAZE_HEIGHT][MAZE_WIDTH];
-        bool visited[MAZE_HEIGHT][MAZE_WIDTH] = {false};
-        QQueue<QPoint> queue;
-
-        queue.enqueue(startPoint);
-        visited[startPoint.y()][startPoint.x()] = true;
-        cameFrom[startPoint.y()][startPoint.x()] = startPoint; // Self-loop
-        m_nextMoveLookup[startId][startId] = startPoint;       // Move to self is "stop"
-
-        while (!queue.isEmpty()) {
-            QPoint current = queue.dequeue();
-
-            QPoint neighbors[4] = {
-                QPoint(current.x(), current.y() - 1), // Up
-                QPoint(current.x(), current.y() + 1), // Down
-                QPoint(current.x() - 1, current.y()), // Left
-                QPoint(current.x() + 1, current.y())  // Right
-            };
-
-            for (const QPoint &neighbor : neighbors) {
-                int nRow = neighbor.y();
-                int nCol = neighbor.x();
-
-                // Check bounds, walls, and visited
-                if (nRow < 0 || nRow >= MAZE_HEIGHT || nCol < 0 || nCol >= MAZE_WIDTH ||
-                    mazeGrid[nRow][nCol] == 1 || visited[nRow][nCol]) {
-                    continue;
-                }
-
-                // Valid new tile found
-                visited[nRow][nCol] = true;
-                cameFrom[nRow][nCol] = current;
-                queue.enqueue(neighbor);
-
-                // --- This is the DP magic ---
-                // We just found the shortest path from startPoint to 'neighbor'
-                // Now, trace back to find the *first step* from startPoint
-
-                QPoint firstStep = neighbor;
-                QPoint traceBack = current;
-
-                // Keep tracing back until the node *before* us is the start point
-                while (traceBack != startPoint) {
-                    firstStep = traceBack;
-                    traceBack = cameFrom[traceBack.y()][traceBack.x()];
-                }
-
-                // We found it! 'firstStep' is the move to make from 'startPoint'.
-                int targetId = m_pointToId[neighbor];
-                m_nextMoveLookup[startId][targetId] = firstStep;
-            }
+        for (const QPoint &cell : eaten) {
+            region += mazeToWidget(QRect(cell * TILE_SIZE, tile), camera) & field;
         }
     }
-    qDebug() << "Path pre-computation complete. " << numValidNodes << "nodes processed.";
-}
-
-
-// === GAME STATE MANAGEMENT ===
-
-void GameWidget::resetGame()
-{
-    m_score = 0;
-    m_round = 1; // Reset round to 1
-    m_gameState = Menu;
-    m_bgMusicPlayer->stop();
-}
-
-void GameWidget::startGame()
-{
-    if (startMacroCol == -1 || startMacroRow == -1) {
-        qDebug() << "Start position 'p' not found!";
-        return;
-    }
-
-    // Don't reset score when coming from Win state (continuing to next round)
-    // Only reset score when starting fresh from Menu or retrying from GameOver
-    if (m_gameState == Menu || m_gameState == GameOver) {
-        m_score = 0;
+    if (snapshot.pelletsLeft != m_drawnPelletsLeft) {
+        region += pelletCounterRect();
     }
-
-    // Copy the original maze back into the working maze
-    for (int row = 0; row < MAZE_HEIGHT; ++row) {
-        for (int col = 0; col < MAZE_WIDTH; ++col) {
-            mazeGrid[row][col] = originalMazeGrid[row][col];
-        }
+    if (m_showProfiler && updateProfilerText()) {
+        region += m_profilerRect;
     }
 
-    // Set Pac-Man's start position
-    QPoint gridCenter = macroGridToGridCenter(startMacroCol, startMacroRow);
-    pacman_grid_center = gridCenter;
-    pacman_macrogrid_center = QPoint(startMacroCol, startMacroRow);
-    m_pacmanDirection = Right;
-
-    // Eat the pellet at the start
-    mazeGrid[startMacroRow][startMacroCol] = 3;
-
-    // Initialize ghosts (this will now use m_round)
-    initializeGhosts();
-
-    m_gameState = Playing;
-    m_bgMusicPlayer->play();
+    m_drawnActors.swap(m_frameActors);
+    m_drawnMaze = snapshot.maze;
+    m_drawnCamera = camera;
+    m_drawnZoom = m_zoomFactor;
+    m_drawnPelletsLeft = snapshot.pelletsLeft;
+    return region;
 }
 
-// ##################################################################
-// ##################################################################
-// ###                                                            ###
-// ###     ALL YOUR PORTED CORE GAME LOGIC GOES BELOW THIS LINE   ###
-// ###   (These are from your mainwindow.cpp, adapted for TILE_SIZE) ###
-// ###                                                            ###
-// ##################################################################
-// ##################################################################
-
-// === ADAPTED from your logic ===
-QPoint GameWidget::macroGridToGridCenter(int macroCol, int macroRow)
+// Where a maze rectangle ends up on the widget, grown a little for
+// antialiased edges
+QRect GameWidget::mazeToWidget(const QRect &mazeRect, QPoint camera) const
 {
-    // Returns the PIXEL center of a macro grid cell
-    int gridX = macroCol * TILE_SIZE + (TILE_SIZE / 2);
-    int gridY = macroRow * TILE_SIZE + (TILE_SIZE / 2);
-    return QPoint(gridX, gridY);
+    QRectF rect(QPointF(mazeRect.topLeft() - camera) * m_zoomFactor, QSizeF(mazeRect.size()) * m_zoomFactor);
+    return rect.translated(LEFT_SIDEBAR_WIDTH, 0).toAlignedRect().adjusted(-2, -2, 2, 2);
 }
 
-// === ADAPTED from your logic ===
-QPoint GameWidget::gridToMacroGrid(int gridX, int gridY)
+QRect GameWidget::pelletCounterRect() const
 {
-    // Returns the macro grid cell (col, row) for a given PIXEL coordinate
-    int macroCol = gridX / TILE_SIZE;
-    int macroRow = gridY / TILE_SIZE;
-    macroCol = qBound(0, macroCol, MAZE_WIDTH - 1);
-    macroRow = qBound(0, macroRow, MAZE_HEIGHT - 1);
-    return QPoint(macroCol, macroRow);
+    return QRect(LEFT_SIDEBAR_WIDTH + VIEW_COLS * TILE_SIZE, 24, RIGHT_SIDEBAR_WIDTH, 60);
 }
 
-// === ADAPTED from your logic ===
-void GameWidget::startAnimatedMove(int tx, int ty) // tx, ty are 0 or +/- TILE_SIZE
+// Re-reads the timings for the overlay, twice a second at most so the
+// figures stay readable. True if the text changed.
+bool GameWidget::updateProfilerText()
 {
-    if (isMoving) return;
-
-    targetX = tx;
-    targetY = ty;
-    currentStep = 0;
-    isMoving = true;
+    if (m_profilerRefresh.isValid() && m_profilerRefresh.elapsed() < 500) {
+        return false;
+    }
+    m_profilerRefresh.start();
 
-    // Calculate pixel delta per step
-    stepDeltaX = (tx != 0) ? (tx / moveSteps) : 0; // e.g., 32 / 8 = 4 pixels
-    stepDeltaY = (ty != 0) ? (ty / moveSteps) : 0; // e.g., 32 / 8 = 4 pixels
+    auto ms = [this](Profiler::Metric metric, double p) {
+        return QString::number(m_profiler.histogram(metric).percentileNs(p) / 1e6, 'f', 2);
+    };
+    const QString text = QString("p50 / p99 ms\nTick\n%1 / %2\nPaint\n%3 / %4\nGhosts %5\nDropped %6")
+                             .arg(ms(Profiler::Tick, 0.5), ms(Profiler::Tick, 0.99),
+                                  ms(Profiler::Paint, 0.5), ms(Profiler::Paint, 0.99))
+                             .arg(m_sim.snapshot().ghosts.size())
+                             .arg(m_profiler.droppedFrames());
+    if (text == m_profilerText) return false;
+    m_profilerText = text;
+    return true;
 }
 
-// === ADAPTED from your logic ===
-bool GameWidget::canMove(int tx, int ty) // tx, ty are -1, 0, or 1 (macro grid delta)
+// 'image' stretched over the whole widget. Scaled once per image, size
+// and mode instead of on every repaint of a static screen.
+QPixmap GameWidget::background(const QPixmap &image) const
 {
-    int newMacroCol = pacman_macrogrid_center.x() + tx;
-    int newMacroRow = pacman_macrogrid_center.y() + ty;
-
-    // Check bounds
-    if (newMacroCol < 0 || newMacroCol >= MAZE_WIDTH || newMacroRow < 0 || newMacroRow >= MAZE_HEIGHT) {
-        return false; // Can't move off screen
-    }
-
-    // Check for wall
-    return mazeGrid[newMacroRow][newMacroCol] != 1;
+    return scaledPixmap(image, size(), devicePixelRatioF(),
+                        m_isPixelatedMode ? Qt::FastTransformation : Qt::SmoothTransformation);
 }
 
-// === ADAPTED from your logic ===
-void GameWidget::animationStep() // Pac-Man's movement
+// Where something moving from 'previous' to 'current' over the last tick is
+// at this frame
+QPoint GameWidget::interpolate(QPoint previous, QPoint current) const
 {
-    if (!isMoving) {
-        return;
-    }
-    currentStep++;
-
-    // Move Pac-Man's pixel center
-    pacman_grid_center.setX(pacman_grid_center.x() + stepDeltaX);
-    pacman_grid_center.setY(pacman_grid_center.y() + stepDeltaY);
-
-    if (currentStep >= moveSteps) {
-        // Finished moving
-        isMoving = false;
-
-        // Snap to the new grid cell's center
-        pacman_macrogrid_center = gridToMacroGrid(pacman_grid_center.x(), pacman_grid_center.y());
-        pacman_grid_center = macroGridToGridCenter(pacman_macrogrid_center.x(), pacman_macrogrid_center.y());
-
-        // Check for pellet
-        collectPellet();
+    const QPoint delta = current - previous;
+    if (delta.manhattanLength() > TILE_SIZE) {
+        return current; // Teleported (respawn, new round, replay seek)
     }
+    return previous + delta * m_frameAlpha;
 }
 
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::loadMaze(const QString &filename)
+// Top-left maze pixel of the view: follows Pac-Man, but never scrolls past
+// the maze edge. Mazes smaller than the view stay at the origin.
+QPoint GameWidget::cameraOrigin() const
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Could not open file:" << filename;
-        return;
-    }
-
-    QTextStream in(&file);
-    int row = 0;
-    startMacroRow = -1;
-    startMacroCol = -1;
-    ghostSpawnPositions.clear();
-
-    while (!in.atEnd() && row < MAZE_HEIGHT) {
-        QString line = in.readLine();
-        for (int col = 0; col < MAZE_WIDTH && col < line.length(); col++) {
-            QChar ch = line[col];
-            int value;
-            if (ch == '1') value = 1;
-            else if (ch == '3' || ch == 'g') {
-                value = 3;
-                if (ch == 'g') ghostSpawnPositions.append(QPoint(col, row));
-            }
-            else if (ch == '4') value = 4;
-            else if (ch == '2') value = 2;
-            else {
-                value = 0;
-                if (ch == 'p') {
-                    startMacroCol = col;
-                    startMacroRow = row;
-                }
-            }
-            mazeGrid[row][col] = value;
-            originalMazeGrid[row][col] = value;
-        }
-        row++;
-    }
-    file.close();
-    precomputePaths();
+    const GameSnapshot &snapshot = m_sim.snapshot();
+    int viewWidth = int(VIEW_COLS * TILE_SIZE / m_zoomFactor);
+    int viewHeight = int(VIEW_ROWS * TILE_SIZE / m_zoomFactor);
+    int mazeWidth = snapshot.maze.width() * TILE_SIZE;
+    int mazeHeight = snapshot.maze.height() * TILE_SIZE;
+
+    QPoint center = interpolate(snapshot.pacmanPrevious, snapshot.pacmanCenter);
+    int x = qBound(0, center.x() - viewWidth / 2, qMax(0, mazeWidth - viewWidth));
+    int y = qBound(0, center.y() - viewHeight / 2, qMax(0, mazeHeight - viewHeight));
+    return QPoint(x, y);
 }
 
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::collectPellet()
+void GameWidget::drawGameOver(QPainter &painter)
 {
-    int macroCol = pacman_macrogrid_center.x();
-    int macroRow = pacman_macrogrid_center.y();
+    painter.fillRect(rect(), Qt::black);
 
-    if (macroCol < 0 || macroCol >= MAZE_WIDTH || macroRow < 0 || macroRow >= MAZE_HEIGHT) {
-        return;
+    // Draw the game over image scaled to fit the frame
+    const QPixmap gameOver = m_assets.pixmap(GAME_OVER_SCREEN);
+    if (!gameOver.isNull()) {
+        painter.drawPixmap(0, 0, background(gameOver));
     }
-    int cellValue = mazeGrid[macroRow][macroCol];
 
-    if (cellValue == 0) {
-        m_score += 1;
-        mazeGrid[macroRow][macroCol] = 3; // Set to empty path
-        m_pelletSfx->play();
-    } else if (cellValue == 4) {
-        m_score += 5;
-        mazeGrid[macroRow][macroCol] = 3;
-        activatePanicMode();
-        m_powerPelletSfx->play();
-    }
+    // Display the score at the top-center area
+    painter.setPen(Qt::yellow);
+    QFont scoreFont("Arial", 32, QFont::Bold);
+    painter.setFont(scoreFont);
+    QRect scoreRect = rect().adjusted(0, 80, 0, 0);
+    painter.drawText(scoreRect, Qt::AlignHCenter | Qt::AlignTop, QString("Score: %1").arg(m_sim.snapshot().score));
 
-    if (checkAllPelletsCollected()) {
-        resetLevel();
-    }
-}
+    // Calculate Try Again button position - bottom aligned
+    int buttonWidth = 220;
+    int buttonHeight = 50;
+    int centerX = width() / 2;
+    int bottomMargin = 80;
+    m_tryAgainButtonRect = QRect(centerX - (buttonWidth / 2), height() - bottomMargin, buttonWidth, buttonHeight);
 
-// === PORTED from your logic (Unchanged) ===
-bool GameWidget::checkAllPelletsCollected()
-{
-    for (int macroRow = 0; macroRow < MAZE_HEIGHT; macroRow++) {
-        for (int macroCol = 0; macroCol < MAZE_WIDTH; macroCol++) {
-            int cellValue = mazeGrid[macroRow][macroCol];
-            if (cellValue == 0 || cellValue == 4) {
-                return false;
-            }
-        }
-    }
-    return true;
+    // Draw Try Again button
+    painter.setPen(QColor(0, 0, 255));
+    painter.setBrush(Qt::yellow);
+    painter.drawRect(m_tryAgainButtonRect);
+    painter.setPen(Qt::black);
+    QFont btnFont("Arial", 24, QFont::Bold);
+    painter.setFont(btnFont);
+    painter.drawText(m_tryAgainButtonRect, Qt::AlignCenter, "TRY AGAIN");
 }
 
-
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::resetLevel()
+// Draws the part 'area' of the HD game field (in field pixels, before zoom)
+// with the painter at the field's top-left. Only reads the widget, so the
+// HD renderer runs it for several tiles at once.
+void GameWidget::drawField(QPainter &painter, const QRect &area, QPoint camera) const
 {
-    // Round is cleared! Transition to Win state
-    m_gameState = Win;
-    m_bgMusicPlayer->stop();
-}
-
+    const GameSnapshot &snapshot = m_sim.snapshot();
+    painter.scale(m_zoomFactor, m_zoomFactor);
+    painter.translate(-camera);
 
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::activatePanicMode()
-{
-    for (Ghost &ghost : ghosts) {
-        if (ghost.active) {
-            ghost.mode = Panic;
-            ghost.path.clear();
-            ghost.pathIndex = 0;
-            // Color is handled by drawGhost
-        }
-    }
-    if (panicTimer->isActive()) {
-        panicTimer->stop();
-    }
-    panicTimer->start(10000); // 10 seconds
-}
+    const QRect visible = QRectF(QPointF(area.topLeft()) / m_zoomFactor + camera,
+                                 QSizeF(area.size()) / m_zoomFactor).toAlignedRect();
+    m_mazeLayer.draw(painter, visible);
 
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::panicModeTimeout()
-{
-    for (Ghost &ghost : ghosts) {
-        if (ghost.active) {
-            ghost.mode = Chase;
-            ghost.path.clear();
-            ghost.pathIndex = 0;
-            // Color is handled by drawGhost
-        }
+    // Actors whose centre is within a tile of the area can reach into it
+    const QRect reach = visible.adjusted(-TILE_SIZE, -TILE_SIZE, TILE_SIZE, TILE_SIZE);
+    const QPoint pacman = interpolate(snapshot.pacmanPrevious, snapshot.pacmanCenter);
+    if (reach.contains(pacman)) {
+        drawPacman(painter, pacman, snapshot.pacmanDirection);
     }
-}
-
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::ghostAnimationStep()
-{
-    if (m_gameState != Playing) return;
-
-    for (int i = 0; i < ghosts.size(); i++) {
-        Ghost &ghost = ghosts[i];
-        if (!ghost.active || ghost.respawning) continue;
-
-        if (ghost.speedMultiplier < 1.0f) {
-            ghost.delayCounter++;
-            int requiredDelay = static_cast<int>((1.0f / ghost.speedMultiplier) - 1.0f);
-            if (ghost.delayCounter < requiredDelay) {
-                continue;
-            }
-            ghost.delayCounter = 0;
-        }
 
-        if (!ghost.moving) {
-            if (ghost.type == IntersectionRandom && isAtIntersection(ghost)) {
-                if (QRandomGenerator::global()->bounded(100) < REPRODUCTION_PROB) {
-                    spawnChildGhost(ghost);
-                }
-            }
-            moveGhost(ghost);
-            continue;
-        }
-
-        ghost.currentStep++;
-        ghost.grid_center.setX(ghost.grid_center.x() + ghost.stepDeltaX);
-        ghost.grid_center.setY(ghost.grid_center.y() + ghost.stepDeltaY);
-
-        if (ghost.currentStep >= ghost.moveSteps) {
-            ghost.moving = false;
-            ghost.macrogrid_center = gridToMacroGrid(ghost.grid_center.x(), ghost.grid_center.y());
-            ghost.grid_center = macroGridToGridCenter(ghost.macrogrid_center.x(), ghost.macrogrid_center.y());
+    for (GhostSprite ghost : snapshot.ghosts) {
+        ghost.center = interpolate(ghost.previous, ghost.center);
+        if (reach.contains(ghost.center)) {
+            drawGhost(painter, ghost);
         }
     }
 }
 
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::checkGhostCollisions()
+// Pac-Man and the ghosts are single blits from the pre-rendered atlas
+void GameWidget::drawPacman(QPainter &painter, QPoint center, Direction dir) const
 {
-    for (Ghost &ghost : ghosts) {
-        if (!ghost.active || ghost.respawning) continue;
-
-        // Pixel-based collision check
-        int dist = std::abs(pacman_grid_center.x() - ghost.grid_center.x()) +
-                   std::abs(pacman_grid_center.y() - ghost.grid_center.y());
-
-        if (dist < TILE_SIZE / 1.5) { // If centers are close
-            if (ghost.mode == Chase) {
-                qDebug() << "Ghost caught Pacman! Game Over!";
-                m_gameState = GameOver;
-                m_bgMusicPlayer->stop();
-                m_gameOverSfx->play();
-                return;
-            } else { // Panic mode
-                qDebug() << "Pacman ate ghost!";
-                m_score += 50;
-                ghost.active = false;
-                ghost.respawning = true;
-
-                // Use a lambda to capture the specific ghost
-                QTimer::singleShot(2000, this, [this, ghostId = ghost.parentId]() {
-                    // Find the ghost by its ID to respawn
-                    for(Ghost &g : ghosts) {
-                        if(g.parentId == ghostId) {
-                            respawnGhost(g);
-                            break;
-                        }
-                    }
-                });
-            }
-        }
-    }
+    m_spriteAtlas.drawPacman(painter, center, m_pacmanColorIdx, dir, m_sim.snapshot().pacmanMouthAngle);
 }
 
-// === PORTED from your logic (Unchanged) ===
-Color GameWidget::getGhostColor(const Ghost &ghost)
+void GameWidget::drawGhost(QPainter &painter, const GhostSprite &ghost) const
 {
-    // This is your exact function, just without the panic part
-    switch (ghost.type) {
-    case Original:
-        return {255, 0, 0}; // Red
-    case AggressiveChaser:
-        return {255, 165, 0}; // Orange
-    case Ambusher:
-        return {255, 105, 180}; // Pink
-    case RandomPatrol:
-        return {0, 255, 255}; // Cyan
-    case IntersectionRandom:
-        return {255, 255, 0}; // Yellow
-    default:
-        return {255, 0, 0};
-    }
+    m_spriteAtlas.drawGhost(painter, ghost.center, ghost.type, ghost.mode, ghost.direction);
 }
 
-// === PORTED from your logic (Unchanged) ===
-void GameWidget::initializeGhosts()
-{
-    ghosts.clear();
-    nextGhostId = 0;
-
-    if (ghostSpawnPositions.isEmpty()) return;
-
-    int numGhosts = 0;
-    if (m_round == 1) numGhosts = 0;
-    if (m_round == 2) numGhosts = 1;
-    if (m_round == 3) numGhosts = 2;
-    if (m_round == 4) numGhosts = 3;
-    if (m_round == 5) numGhosts = 4;
-    if (m_round == 6) numGhosts = 4;
-    if (m_round == 7) numGhosts = 1;
-
-    for (int i = 0; i < numGhosts && i < ghostSpawnPositions.size(); i++) {
-        Ghost ghost;
-        GhostType type;
-        if (m_round == 7) type = IntersectionRandom;
-        else if (i == 0) type = Original;
-        else if (i == 1) type = IntersectionRandom;
-        else if (i == 2) type = Ambusher;
-        else type = RandomPatrol;
-        initializeGhost(ghost, i, type);
-        if (m_round == 6) {
-            if (i == 0) ghost.speedMultiplier = 0.5f;
-            else if (i == 1) ghost.speedMultiplier = 0.7f;
-            else if (i == 2) ghost.speedMultiplier = 0.9f;
-            else if (i == 3) ghost.speedMultiplier = 1.1f;
-        }
-        if (m_round == 7) {
-            ghost.speedMultiplier = 0.5f;
-        }
-        ghosts.append(ghost);
-    }
-}
-
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::initializeGhost(Ghost &ghost, int spawnIndex, GhostType type)
-{
-    QPoint spawnMacro = ghostSpawnPositions[spawnIndex % ghostSpawnPositions.size()];
-    QPoint spawnGrid = macroGridToGridCenter(spawnMacro.x(), spawnMacro.y());
-
-    ghost.grid_center = spawnGrid;
-    ghost.macrogrid_center = spawnMacro;
-    ghost.type = type;
-    ghost.active = true;
-    ghost.mode = Chase;
-    ghost.direction = Stop;
-    ghost.moving = false;
-    ghost.moveSteps = MOVESTEPS; // Adapted
-    ghost.currentStep = 0;
-    ghost.path.clear();
-    ghost.pathIndex = 0;
-    ghost.respawning = false;
-    ghost.failCounter = 0;
-    ghost.speedMultiplier = 1.0f;
-    ghost.moveDelay = 0;
-    ghost.delayCounter = 0;
-    ghost.parentId = nextGhostId++;
-    ghost.color = getGhostColor(ghost); // Set its color
-}
-
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::respawnGhost(Ghost &ghost)
-{
-    if (ghostSpawnPositions.isEmpty()) {
-        ghost.respawning = false;
-        return;
-    }
-    QPoint spawnMacro = ghostSpawnPositions[0];
-    QPoint spawnGrid = macroGridToGridCenter(spawnMacro.x(), spawnMacro.y());
-
-    ghost.grid_center = spawnGrid;
-    ghost.macrogrid_center = spawnMacro;
-    ghost.active = true;
-    ghost.respawning = false;
-    ghost.mode = Chase;
-    ghost.direction = Stop;
-    ghost.path.clear();
-    ghost.pathIndex = 0;
-    ghost.moving = false;
-    ghost.currentStep = 0;
-    // Color is set automatically by drawGhost
-}
+// === GAME STATE MANAGEMENT ===
 
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::spawnChildGhost(const Ghost &parent)
+void GameWidget::resetGame()
 {
-    if (ghostSpawnPositions.isEmpty() || ghosts.size() >= MAX_GHOSTS) return;
-    Ghost child;
-    child.grid_center = parent.grid_center;
-    child.macrogrid_center = parent.macrogrid_center;
-    child.type = IntersectionRandom;
-    child.active = true;
-    child.mode = Chase;
-    child.direction = Stop;
-    child.moving = false;
-    child.moveSteps = MOVESTEPS; // Adapted
-    child.currentStep = 0;
-    child.path.clear();
-    child.pathIndex = 0;
-    child.respawning = false;
-    child.failCounter = 0;
-    child.speedMultiplier = 0.5f;
-    child.moveDelay = 0;
-    child.delayCounter = 0;
-    child.parentId = nextGhostId++;
-    child.color = getGhostColor(child);
-    ghosts.append(child);
+    m_round = 1; // Reset round to 1
+    m_gameState = Menu;
+    m_sim.pause();
+    m_bgMusicPlayer->stop();
 }
 
-// === ADAPTED from your logic (Ghosts) ===
-void GameWidget::moveGhost(Ghost &ghost)
+void GameWidget::startGame()
 {
-    if (!ghost.active || ghost.moving) return;
-
-    ghost.direction = getGhostDirection(ghost);
+    // Don't reset score when coming from Win state (continuing to next round)
+    // Only reset score when starting fresh from Menu or retrying from GameOver
+    bool resetScore = (m_gameState == Menu || m_gameState == GameOver);
 
-    if (ghost.direction == Stop) {
-        ghost.path.clear();
-        ghost.pathIndex = 0;
+    // Restores the maze, places Pac-Man and initializes ghosts for m_round.
+    // A fresh seed per game; logging it lets any session be replayed exactly.
+    quint64 seed = QRandomGenerator::global()->generate64();
+    if (!m_sim.startRound(m_round, resetScore, seed, sessionLogPath())) {
         return;
     }
 
-    ghost.moving = true;
-    ghost.currentStep = 0;
-    ghost.moveSteps = MOVESTEPS; // Adapted
-
-    int stepSize = TILE_SIZE / ghost.moveSteps; // e.g., 4 pixels
-    switch (ghost.direction) {
-    case Up:    ghost.stepDeltaX = 0; ghost.stepDeltaY = -stepSize; break;
-    case Down:  ghost.stepDeltaX = 0; ghost.stepDeltaY = stepSize;  break;
-    case Left:  ghost.stepDeltaX = -stepSize; ghost.stepDeltaY = 0; break;
-    case Right: ghost.stepDeltaX = stepSize;  ghost.stepDeltaY = 0; break;
-    default:    ghost.moving = false; return;
-    }
-}
-
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getGhostDirection(Ghost &ghost)
-{
-    if (ghost.mode == Panic) {
-        return getGhostPanicDirection(ghost);
-    }
-    switch (ghost.type) {
-    case Original: return getGhostChaseDirection(ghost);
-    case AggressiveChaser: return getAggressiveChaserDirection(ghost);
-    case Ambusher: return getAmbusherDirection(ghost);
-    case RandomPatrol: return getRandomPatrolDirection(ghost);
-    case IntersectionRandom: return getIntersectionRandomDirection(ghost);
-    default: return getGhostChaseDirection(ghost);
-    }
-}
-
-// === PORTED from your logic (Unchanged) ===
-// QVector<QPoint> GameWidget::getNeighborMacroCells(QPoint macroCell)
-// {
-//     QVector<QPoint> neighbors;
-//     int col = macroCell.x();
-//     int row = macroCell.y();
-//     if (row > 0 && mazeGrid[row - 1][col] != 1) neighbors.append(QPoint(col, row - 1));
-//     if (row < MAZE_HEIGHT - 1 && mazeGrid[row + 1][col] != 1) neighbors.append(QPoint(col, row + 1));
-//     if (col > 0 && mazeGrid[row][col - 1] != 1) neighbors.append(QPoint(col - 1, row));
-//     if (col < MAZE_WIDTH - 1 && mazeGrid[row][col + 1] != 1) neighbors.append(QPoint(col + 1, row));
-//     return neighbors;
-// }
-
-// // === PORTED from your logic (Unchanged) ===
-// QVector<QPoint> GameWidget::findPath(QPoint start, QPoint target)
-// {
-//     QQueue<QPoint> queue;
-//     QHash<QPoint, QPoint> cameFrom;
-//     QSet<QPoint> visited;
-//     queue.enqueue(start);
-//     visited.insert(start);
-//     cameFrom[start] = start;
-//     bool foundTarget = false;
-//     while (!queue.isEmpty()) {
-//         QPoint current = queue.dequeue();
-//         if (current == target) {
-//             foundTarget = true;
-//             break;
-//         }
-//         QVector<QPoint> neighbors = getNeighborMacroCells(current);
-//         for (const QPoint &neighbor : neighbors) {
-//             if (!visited.contains(neighbor)) {
-//                 visited.insert(neighbor);
-//                 cameFrom[neighbor] = current;
-//                 queue.enqueue(neighbor);
-//             }
-//         }
-//     }
-//     QVector<QPoint> path;
-//     if (foundTarget) {
-//         QPoint current = target;
-//         while (current != start) {
-//             path.prepend(current);
-//             current = cameFrom[current];
-//         }
-//     }
-//     return path;
-// }
-
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getGhostChaseDirection(Ghost &ghost)
-{
-    QPoint ghostMacro = ghost.macrogrid_center;
-    QPoint pacmanMacro = pacman_macrogrid_center;
-
-    // Check if points are valid (in case one is in a wall, though they shouldn't be)
-    if (!m_pointToId.contains(ghostMacro) || !m_pointToId.contains(pacmanMacro)) {
-        return Stop;
-    }
-
-    // --- DP TABLE LOOKUP ---
-    int startId = m_pointToId[ghostMacro];
-    int targetId = m_pointToId[pacmanMacro];
-    QPoint nextMove = m_nextMoveLookup[startId][targetId];
-
-    // --- Convert the 'nextMove' point to a Direction ---
-    int dx = nextMove.x() - ghostMacro.x();
-    int dy = nextMove.y() - ghostMacro.y();
-
-    if (dx > 0) return Right;
-    if (dx < 0) return Left;
-    if (dy > 0) return Down;
-    if (dy < 0) return Up;
-
-    return Stop; // This happens if ghost is already at the target
-}
-
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getAggressiveChaserDirection(Ghost &ghost)
-{
-    ghost.failCounter++;
-    if (ghost.failCounter >= 8) {
-        ghost.failCounter = 0;
-        QVector<Direction> validDirs;
-        if (canGhostMove(ghost, Up)) validDirs.append(Up);
-        if (canGhostMove(ghost, Down)) validDirs.append(Down);
-        if (canGhostMove(ghost, Left)) validDirs.append(Left);
-        if (canGhostMove(ghost, Right)) validDirs.append(Right);
-        if (!validDirs.isEmpty()) {
-            return validDirs[QRandomGenerator::global()->bounded(validDirs.size())];
-        }
-    }
-    return getGhostChaseDirection(ghost);
-}
-
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getAmbusherDirection(Ghost &ghost)
-{
-    QPoint ghostMacro = ghost.macrogrid_center;
-    QPoint pacmanMacro = pacman_macrogrid_center;
-    QPoint targetMacro = pacmanMacro;
-
-    // Target 4 tiles ahead of Pac-Man
-    switch(m_pacmanDirection) {
-    case Up:    targetMacro.setY(targetMacro.y() - 4); break;
-    case Down:  targetMacro.setY(targetMacro.y() + 4); break;
-    case Left:  targetMacro.setX(targetMacro.x() - 4); break;
-    case Right: targetMacro.setX(targetMacro.x() + 4); break;
-    default: break;
-    }
-
-    // Clamp to maze bounds
-    targetMacro.setX(qBound(0, targetMacro.x(), MAZE_WIDTH - 1));
-    targetMacro.setY(qBound(0, targetMacro.y(), MAZE_HEIGHT - 1));
-
-    // If target is a wall or invalid, default to chasing Pac-Man directly
-    if (mazeGrid[targetMacro.y()][targetMacro.x()] == 1 || !m_pointToId.contains(targetMacro)) {
-        targetMacro = pacmanMacro;
-    }
-
-    // --- DP TABLE LOOKUP ---
-    if (!m_pointToId.contains(ghostMacro)) return Stop; // Should not happen
-
-    int startId = m_pointToId[ghostMacro];
-    int targetId = m_pointToId[targetMacro];
-    QPoint nextMove = m_nextMoveLookup[startId][targetId];
-
-    // --- Convert the 'nextMove' point to a Direction ---
-    int dx = nextMove.x() - ghostMacro.x();
-    int dy = nextMove.y() - ghostMacro.y();
-
-    if (dx > 0) return Right;
-    if (dx < 0) return Left;
-    if (dy > 0) return Down;
-    if (dy < 0) return Up;
+    m_gameState = Playing;
+    m_bgMusicPlayer->play();
+    startFrameLoop();
 
-    return Stop;
+    // Either end screen can follow, so have both ready by then
+    m_assets.request(WIN_SCREEN);
+    m_assets.request(GAME_OVER_SCREEN);
 }
 
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getRandomPatrolDirection(Ghost &ghost)
+bool GameWidget::loadMaze(const QString &path)
 {
-    if (ghost.direction != Stop && QRandomGenerator::global()->bounded(100) < 70) {
-        if (canGhostMove(ghost, ghost.direction)) {
-            return ghost.direction;
-        }
-    }
-    QVector<Direction> validDirs;
-    if (canGhostMove(ghost, Up)) validDirs.append(Up);
-    if (canGhostMove(ghost, Down)) validDirs.append(Down);
-    if (canGhostMove(ghost, Left)) validDirs.append(Left);
-    if (canGhostMove(ghost, Right)) validDirs.append(Right);
-    if (!validDirs.isEmpty()) {
-        return validDirs[QRandomGenerator::global()->bounded(validDirs.size())];
-    }
-    return Stop;
+    return m_sim.loadMaze(path);
 }
 
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getIntersectionRandomDirection(Ghost &ghost)
+bool GameWidget::startReplay(const QString &path)
 {
-    if (isAtIntersection(ghost)) {
-        QVector<Direction> validDirs;
-        if (canGhostMove(ghost, Up)) validDirs.append(Up);
-        if (canGhostMove(ghost, Down)) validDirs.append(Down);
-        if (canGhostMove(ghost, Left)) validDirs.append(Left);
-        if (canGhostMove(ghost, Right)) validDirs.append(Right);
-        if (!validDirs.isEmpty()) {
-            return validDirs[QRandomGenerator::global()->bounded(validDirs.size())];
-        }
-    } else {
-        if (ghost.direction != Stop && canGhostMove(ghost, ghost.direction)) {
-            return ghost.direction;
-        }
-        QVector<Direction> validDirs;
-        if (canGhostMove(ghost, Up)) validDirs.append(Up);
-        if (canGhostMove(ghost, Down)) validDirs.append(Down);
-        if (canGhostMove(ghost, Left)) validDirs.append(Left);
-        if (canGhostMove(ghost, Right)) validDirs.append(Right);
-        if (!validDirs.isEmpty()) {
-            return validDirs[QRandomGenerator::global()->bounded(validDirs.size())];
-        }
-    }
-    return Stop;
-}
-
-// === PORTED from your logic (Unchanged) ===
-Direction GameWidget::getGhostPanicDirection(Ghost &ghost)
-{
-    // Run to a random valid neighbor
-    if (isAtIntersection(ghost) && QRandomGenerator::global()->bounded(100) < 50) {
-        QVector<Direction> validDirs;
-        if (canGhostMove(ghost, Up)) validDirs.append(Up);
-        if (canGhostMove(ghost, Down)) validDirs.append(Down);
-        if (canGhostMove(ghost, Left)) validDirs.append(Left);
-        if (canGhostMove(ghost, Right)) validDirs.append(Right);
-        if (!validDirs.isEmpty()) {
-            return validDirs[QRandomGenerator::global()->bounded(validDirs.size())];
-        }
-    }
-
-    // Try to run away from Pac-Man
-    QPoint ghostMacro = ghost.macrogrid_center;
-    QPoint pacmanMacro = pacman_macrogrid_center;
-    int dx = ghostMacro.x() - pacmanMacro.x();
-    int dy = ghostMacro.y() - pacmanMacro.y();
-
-    if (std::abs(dx) > std::abs(dy)) {
-        if (dx > 0 && canGhostMove(ghost, Right)) return Right;
-        if (dx < 0 && canGhostMove(ghost, Left)) return Left;
-    } else {
-        if (dy > 0 && canGhostMove(ghost, Down)) return Down;
-        if (dy < 0 && canGhostMove(ghost, Up)) return Up;
+    int round;
+    if (!m_sim.startReplay(path, &round)) {
+        return false;
     }
 
-    // Fallback to random
-    return getRandomPatrolDirection(ghost);
+    m_round = round;
+    m_gameState = Playing;
+    m_bgMusicPlayer->play();
+    startFrameLoop();
+    qDebug() << "Replaying" << path << "(PageUp/PageDown to skip)";
+    return true;
 }
 
-// === ADAPTED from your logic (Ghosts) ===
-bool GameWidget::canGhostMove(const Ghost &ghost, Direction dir)
+QString GameWidget::sessionLogPath() const
 {
-    int tx = 0, ty = 0;
-    switch(dir) {
-    case Up: ty = -1; break;
-    case Down: ty = 1; break;
-    case Left: tx = -1; break;
-    case Right: tx = 1; break;
-    default: return false;
-    }
-
-    int newMacroCol = ghost.macrogrid_center.x() + tx;
-    int newMacroRow = ghost.macrogrid_center.y() + ty;
-
-    if (newMacroCol < 0 || newMacroCol >= MAZE_WIDTH || newMacroRow < 0 || newMacroRow >= MAZE_HEIGHT) {
-        return false;
-    }
-
-    // Ghosts can't enter wall (1) or spawn (2)
-    int cell = mazeGrid[newMacroRow][newMacroCol];
-    // ===========================
-    // return (cell != 1 && cell != 2);
-    return (cell != 1);
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sessions";
+    QDir().mkpath(dir);
+    QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    return QString("%1/session-%2-round%3.pmrec").arg(dir, stamp).arg(m_round);
 }
 
 // === PORTED from your logic (Unchanged) ===
-bool GameWidget::isAtIntersection(const Ghost &ghost)
+void GameWidget::resetLevel()
 {
-    QPoint macro = ghost.macrogrid_center;
-    int pathCount = 0;
-    if (macro.y() > 0 && mazeGrid[macro.y() - 1][macro.x()] != 1) pathCount++;
-    if (macro.y() < MAZE_HEIGHT - 1 && mazeGrid[macro.y() + 1][macro.x()] != 1) pathCount++;
-    if (macro.x() > 0 && mazeGrid[macro.y()][macro.x() - 1] != 1) pathCount++;
-    if (macro.x() < MAZE_WIDTH - 1 && mazeGrid[macro.y()][macro.x() + 1] != 1) pathCount++;
-    return pathCount >= 3;
+    // Round is cleared! Transition to Win state
+    m_gameState = Win;
+    m_bgMusicPlayer->stop();
 }
@@ -0,0 +1,187 @@
+#ifndef GAMEWIDGET_H
+#define GAMEWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QRegion>
+#include <QStaticText>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QPaintEvent>
+#include <QTimerEvent>
+#include <QVector>
+#include <QColor>
+#include <QFont>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QMediaPlayer>
+#include <QAudioOutput>
+#include <QSoundEffect>
+
+#include "assetmanager.h"
+#include "mazelayer.h"
+#include "pixelframe.h"
+#include "profiler.h"
+#include "simulationthread.h"
+#include "spriteatlas.h"
+#include "tilerenderer.h"
+
+#define LEFT_SIDEBAR_WIDTH 80
+#define RIGHT_SIDEBAR_WIDTH 80
+
+// Maze cells shown at once (at zoom 1). Bigger mazes scroll with Pac-Man.
+#define VIEW_COLS 29
+#define VIEW_ROWS 20
+
+enum GameState { Menu, Playing, Win, GameOver };
+
+class GameWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    GameWidget(QWidget *parent = nullptr);
+    ~GameWidget();
+
+    // Replaces the built-in map; call before the first game starts
+    bool loadMaze(const QString &path);
+
+    // Plays back a recorded session at normal speed instead of live input
+    bool startReplay(const QString &path);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void timerEvent(QTimerEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onClientDisconnected();
+
+private:
+    // Setup
+    void loadAssets();
+    void initializeSocketServer();
+    void processMovementCommand(const QString &command);
+
+    // State
+    void resetGame();
+    void startGame();
+    void resetLevel();
+    void handleSnapshot();
+    void startFrameLoop();
+    void queueInput(Direction dir, InputSource source);
+    QString sessionLogPath() const;
+
+    // Drawing
+    QPoint interpolate(QPoint previous, QPoint current) const;
+    QPoint cameraOrigin() const;
+    QRegion damagedRegion();
+    QRect mazeToWidget(const QRect &mazeRect, QPoint camera) const;
+    QRect pelletCounterRect() const;
+    bool updateProfilerText();
+    QPixmap background(const QPixmap &image) const;
+    const QPixmap &hudLayer();
+    void drawCenteredText(QPainter &painter, const QRect &rect, const QStaticText &text);
+    void drawMenu(QPainter &painter);
+    void drawGame(QPainter &painter, const QRegion &dirty);
+    void drawField(QPainter &painter, const QRect &area, QPoint camera) const;
+    void drawWin(QPainter &painter);
+    void drawGameOver(QPainter &painter);
+    void drawPacman(QPainter &painter, QPoint center, Direction dir) const;
+    void drawGhost(QPainter &painter, const GhostSprite &ghost) const;
+
+    // Hot-path timings, written at the end of the session. Declared before
+    // m_sim, which records into it until it stops.
+    Profiler m_profiler;
+    bool m_showProfiler;                // Overlay in the right sidebar (F3)
+    QFont m_profilerFont;
+    QRect m_profilerRect;
+    QString m_profilerText;
+    QElapsedTimer m_profilerRefresh;
+
+    // The simulation itself (maze, Pac-Man, ghosts, score) runs on its own
+    // thread; the widget only sends it commands and input and draws its
+    // snapshots. Every game is logged there so therapy sessions can be
+    // reviewed afterwards.
+    SimulationThread m_sim;
+
+    GameState m_gameState;
+    int m_round;
+
+    // Frame loop, at the display's refresh rate and only while playing.
+    // Frames draw Pac-Man and the ghosts between their last two tick
+    // positions in the latest snapshot and repaint only what changed.
+    int m_frameTimerId;                 // 0 while stopped
+    qint64 m_frameIntervalNs;
+    QElapsedTimer m_frameClock;         // Since the last frame, for dropped frames
+    qreal m_frameAlpha;                 // 0 = previous tick, 1 = latest tick
+    QVector<QRect> m_drawnActors;       // Maze rects of the last frame's actors
+    QVector<QRect> m_frameActors;       // Scratch for this frame's, swapped in
+    MazeBits m_drawnMaze;
+    QPoint m_drawnCamera;
+    float m_drawnZoom;
+    int m_drawnPelletsLeft;
+
+    // HUD: sidebars and colour bar cached in one layer for the round,
+    // colour and mode it was drawn for; only the pellet count is per frame
+    QPixmap m_hudLayer;
+    int m_hudRound;
+    int m_hudColorIdx;
+    bool m_hudPixelated;
+    QFont m_hudButtonFont;
+    QFont m_hudSmallFont;
+    QVector<QStaticText> m_roundLabels;
+    QStaticText m_plusLabel;
+    QStaticText m_minusLabel;
+    QStaticText m_winLabel;
+    QStaticText m_pelletCountText;
+    QRect m_pelletCountRect;
+    int m_pelletCountValue;
+
+    // Sprites
+    QPixmap m_wallSprite;
+    QPixmap m_pelletSprite;
+    QPixmap m_powerPelletSprite;
+    QPixmap m_emptySprite;
+    AssetManager m_assets;              // Decodes and keeps every image
+    bool m_isPixelatedMode;
+    bool m_firstPaintDone;              // For the startup timeline
+    MazeLayer m_mazeLayer;             // Maze drawn with the sprites above
+    SpriteAtlas m_spriteAtlas;         // Every Pac-Man and ghost frame
+    TileRenderer m_fieldRenderer;      // HD game field, on all cores
+    PixelFrame m_pixelFrame;           // Pixel mode's game field
+
+    // UI
+    QRect m_startButtonRect;
+    QRect m_tryAgainButtonRect;
+    QRect m_nextRoundButtonRect;
+    QRect m_highResBtnRect;
+    QRect m_pixelBtnRect;
+    QRect m_levelDownRect;
+    QRect m_levelUpRect;
+    QRect m_winSidebarBtnRect;
+    QVector<QRect> m_roundBtnRects;
+    QRect m_zoomInRect;
+    QRect m_zoomOutRect;
+    float m_zoomFactor;
+    QVector<QColor> m_colorBtnColors;
+    QVector<QRect> m_colorBtnRects;
+    int m_pacmanColorIdx;
+
+    // Audio
+    QMediaPlayer *m_bgMusicPlayer;
+    QAudioOutput *m_audioOutput;
+    QSoundEffect *m_pelletSfx;
+    QSoundEffect *m_powerPelletSfx;
+    QSoundEffect *m_gameOverSfx;
+
+    // Head pose socket
+    QTcpServer *tcpServer;
+    QTcpSocket *clientSocket;
+};
+
+#endif // GAMEWIDGET_H
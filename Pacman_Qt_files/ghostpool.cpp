@@ -0,0 +1,95 @@
+#include "ghostpool.h"
+
+GhostPool::GhostPool(int capacity)
+    : state(capacity, 0),
+    center(capacity),
+    cell(capacity),
+    stepDelta(capacity),
+    currentStep(capacity, 0),
+    moveSteps(capacity, 0),
+    mode(capacity, 0),
+    delayTicks(capacity, 0),
+    delayCounter(capacity, 0),
+    traits(capacity),
+    m_generation(capacity, 0),
+    m_count(0)
+{
+    clear();
+}
+
+void GhostPool::clear()
+{
+    for (int slot = 0; slot < capacity(); ++slot) {
+        if (state[slot] & InUse) {
+            m_generation[slot]++;
+        }
+        state[slot] = 0;
+    }
+    m_count = 0;
+}
+
+GhostHandle GhostPool::spawn(const Ghost &ghost)
+{
+    if (isFull()) {
+        return GhostHandle();
+    }
+    int slot = m_count++;
+    store(slot, ghost);
+    return handle(slot);
+}
+
+bool GhostPool::isValid(GhostHandle handle) const
+{
+    return handle.slot >= 0 && handle.slot < capacity() && (state[handle.slot] & InUse) &&
+           m_generation[handle.slot] == handle.generation;
+}
+
+Ghost GhostPool::ghost(int slot) const
+{
+    const GhostTraits &cold = traits[slot];
+    Ghost ghost;
+    ghost.grid_center = center[slot];
+    ghost.macrogrid_center = cell[slot];
+    ghost.type = cold.type;
+    ghost.mode = GhostMode(mode[slot]);
+    ghost.direction = cold.direction;
+    ghost.color = cold.color;
+    ghost.active = state[slot] & Active;
+    ghost.moving = state[slot] & Moving;
+    ghost.respawning = state[slot] & Respawning;
+    ghost.moveSteps = moveSteps[slot];
+    ghost.currentStep = currentStep[slot];
+    ghost.stepDeltaX = stepDelta[slot].x();
+    ghost.stepDeltaY = stepDelta[slot].y();
+    ghost.failCounter = cold.failCounter;
+    ghost.speedMultiplier = cold.speedMultiplier;
+    ghost.delayCounter = delayCounter[slot];
+    ghost.parentId = cold.parentId;
+    return ghost;
+}
+
+void GhostPool::store(int slot, const Ghost &ghost)
+{
+    state[slot] = InUse | (ghost.active ? Active : 0) | (ghost.moving ? Moving : 0) |
+                  (ghost.respawning ? Respawning : 0);
+    center[slot] = ghost.grid_center;
+    cell[slot] = ghost.macrogrid_center;
+    stepDelta[slot] = QPoint(ghost.stepDeltaX, ghost.stepDeltaY);
+    currentStep[slot] = quint8(ghost.currentStep);
+    moveSteps[slot] = quint8(ghost.moveSteps);
+    mode[slot] = quint8(ghost.mode);
+    delayCounter[slot] = quint8(ghost.delayCounter);
+
+    // Slow ghosts wait (1 / speed - 1) ticks between steps. Below two the
+    // counter resets on the tick it starts, so those ghosts never wait.
+    int delay = ghost.speedMultiplier < 1.0f ? static_cast<int>((1.0f / ghost.speedMultiplier) - 1.0f) : 0;
+    delayTicks[slot] = quint8(qBound(0, delay, 255));
+
+    GhostTraits &cold = traits[slot];
+    cold.type = ghost.type;
+    cold.direction = ghost.direction;
+    cold.color = ghost.color;
+    cold.failCounter = ghost.failCounter;
+    cold.speedMultiplier = ghost.speedMultiplier;
+    cold.parentId = ghost.parentId;
+}
@@ -0,0 +1,81 @@
+#ifndef GHOSTPOOL_H
+#define GHOSTPOOL_H
+
+#include <QPoint>
+#include <QVector>
+
+#include "gametypes.h"
+
+// Refers to a pool slot and the generation it had when the ghost was
+// spawned, so a stale handle is detected instead of hitting whatever ghost
+// reuses the slot later.
+struct GhostHandle {
+    int slot = -1;
+    quint32 generation = 0;
+};
+
+// Fields a ghost only needs when it picks a new direction (about once per
+// cell), kept out of the arrays the per-tick loops walk
+struct GhostTraits {
+    GhostType type;
+    Direction direction;
+    Color color;
+    int failCounter;
+    float speedMultiplier;
+    int parentId;
+};
+
+// Fixed-capacity ghost storage, structure-of-arrays.
+//
+// The per-tick fields (position, step, speed delay, mode, state bits) each
+// live in their own array indexed by slot, so the movement and collision
+// loops stream through a few small arrays instead of whole Ghost structs.
+// Ghosts stay on the board once spawned (eaten ones respawn in their own
+// slot), so slots fill up in spawn order until the pool is cleared.
+class GhostPool
+{
+public:
+    enum StateFlag {
+        InUse      = 0x1,
+        Active     = 0x2,
+        Moving     = 0x4,
+        Respawning = 0x8
+    };
+
+    explicit GhostPool(int capacity = MAX_GHOSTS);
+
+    void clear();
+    int capacity() const { return state.size(); }
+    int count() const { return m_count; }
+    int end() const { return m_count; } // Slots at or past this are all free
+    bool isFull() const { return m_count == capacity(); }
+
+    // Returns an invalid handle (slot -1) when the pool is full
+    GhostHandle spawn(const Ghost &ghost);
+    bool isValid(GhostHandle handle) const;
+    GhostHandle handle(int slot) const { return { slot, m_generation[slot] }; }
+
+    // Whole-ghost copies for the AI, drawing and snapshots
+    Ghost ghost(int slot) const;
+    void store(int slot, const Ghost &ghost);
+
+    // Hot, per tick
+    QVector<quint8> state;        // StateFlag bits
+    QVector<QPoint> center;       // Pixel center
+    QVector<QPoint> cell;         // Maze cell (col, row)
+    QVector<QPoint> stepDelta;    // Pixels per animation step
+    QVector<quint8> currentStep;
+    QVector<quint8> moveSteps;
+    QVector<quint8> mode;         // GhostMode
+    QVector<quint8> delayTicks;   // Ticks per step for slow ghosts, 0 = every tick
+    QVector<quint8> delayCounter;
+
+    // Cold, per decision
+    QVector<GhostTraits> traits;
+
+private:
+    QVector<quint32> m_generation;
+    int m_count;
+};
+
+#endif // GHOSTPOOL_H
@@ -1,11 +1,201 @@
 #include "gamewidget.h" // <-- Include your new class
+#include "gamecore.h"
+#include "batchsimulator.h"
+#include "gamerng.h"
+#include "sessionlog.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+// Runs the game logic without any window, as fast as the CPU allows.
+// Pac-Man wanders on random input and every finished game restarts the
+// same round, so this doubles as a benchmark and a soak test.
+static int runHeadless(const QString &mazeFile, qint64 ticks, int round, quint64 seed)
+{
+    QTextStream out(stdout);
+
+    GameCore core;
+    if (!core.loadMaze(mazeFile) || !core.startRound(round, true, seed)) {
+        out << "Could not start round " << round << Qt::endl;
+        return 1;
+    }
+
+    GameRng inputRng(~seed);
+    Direction input = Right;
+    int gamesPlayed = 0;
+    int wins = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < ticks; ++i) {
+        // Keep heading the same way, but turn every now and then
+        if (inputRng.bounded(8) == 0) {
+            input = static_cast<Direction>(inputRng.bounded(4));
+        }
+
+        core.step(input);
+
+        if (core.status() != GameCore::Running) {
+            gamesPlayed++;
+            if (core.status() == GameCore::Won) wins++;
+            core.startRound(round, true, seed + gamesPlayed);
+        }
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    double seconds = elapsedNs / 1e9;
+    out << "Ticks:        " << ticks << Qt::endl;
+    out << "Elapsed:      " << QString::number(seconds * 1000.0, 'f', 2) << " ms" << Qt::endl;
+    out << "Ticks/sec:    " << QString::number(seconds > 0 ? ticks / seconds : 0.0, 'f', 0) << Qt::endl;
+    out << "Real time x:  " << QString::number(seconds > 0 ? (ticks * FRAMETIME / 1000.0) / seconds : 0.0, 'f', 1) << Qt::endl;
+    out << "Games played: " << gamesPlayed << " (" << wins << " won)" << Qt::endl;
+    return 0;
+}
+
+// Plays --games seeded games for every round on all cores and prints
+// survival, pellet and catch statistics per round.
+static int runBatch(const QCommandLineParser &parser)
+{
+    QTextStream out(stdout);
+
+    GameCore prototype;
+    if (!prototype.loadMaze(parser.value("maze"))) {
+        return 1;
+    }
+
+    BatchSimulator::Config config;
+    config.gamesPerRound = qMax(1, parser.value("games").toInt());
+    config.maxTicks = qMax(1, parser.value("max-ticks").toInt());
+    config.seed = parser.value("seed").toULongLong();
+    config.threads = parser.value("threads").toInt();
+    config.controller = parser.value("controller") == "greedy" ? BatchSimulator::GreedyController
+                                                               : BatchSimulator::RandomController;
+    if (parser.isSet("round")) {
+        config.firstRound = config.lastRound = qBound(1, parser.value("round").toInt(), 7);
+    }
+
+    BatchSimulator simulator(prototype);
+    QVector<BatchSimulator::RoundReport> reports = simulator.run(config);
+    BatchSimulator::printReport(out, reports);
+
+    int totalGames = (config.lastRound - config.firstRound + 1) * config.gamesPerRound;
+    double seconds = simulator.lastRunNs() / 1e9;
+    out << totalGames << " games in " << QString::number(seconds, 'f', 2) << " s ("
+        << QString::number(seconds > 0 ? totalGames / seconds : 0.0, 'f', 0) << " games/s)" << Qt::endl;
+    return 0;
+}
+
+// Replays a session log at full CPU speed, checks that it reproduces the
+// recorded result and optionally times a seek (--seek TICK).
+static int runReplay(const QCommandLineParser &parser)
+{
+    QTextStream out(stdout);
+    static const char *statusNames[] = { "running", "won", "lost" };
+
+    SessionReplayer replayer;
+    GameCore core;
+    if (!replayer.open(parser.value("replay")) || !replayer.start(core)) {
+        out << "Could not replay " << parser.value("replay") << Qt::endl;
+        return 1;
+    }
+    out << "Seed " << replayer.seed() << ", round " << replayer.round() << ", "
+        << replayer.events().size() << " inputs, " << replayer.keyframeCount() << " keyframes, "
+        << replayer.endTick() << " ticks" << Qt::endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    while (replayer.step(core) >= 0) {
+    }
+    double ms = timer.nsecsElapsed() / 1e6;
+    out << "Replayed to tick " << core.tick() << " in " << QString::number(ms, 'f', 2) << " ms: "
+        << statusNames[core.status()] << ", score " << core.score() << Qt::endl;
+
+    if (replayer.hasEnd() && (core.status() != replayer.endStatus() || core.score() != replayer.endScore())) {
+        out << "MISMATCH: recorded " << statusNames[replayer.endStatus()] << ", score "
+            << replayer.endScore() << Qt::endl;
+        return 2;
+    }
+
+    if (parser.isSet("seek")) {
+        quint64 target = parser.value("seek").toULongLong();
+        timer.restart();
+        replayer.seek(core, target);
+        ms = timer.nsecsElapsed() / 1e6;
+        out << "Seek to tick " << core.tick() << " took " << QString::number(ms, 'f', 3) << " ms: score "
+            << core.score() << ", " << core.pelletsLeft() + core.powerPelletsLeft() << " pellets left, "
+            << "Pac-Man at (" << core.pacmanCell().x() << ", " << core.pacmanCell().y() << "), "
+            << core.ghostList().size() << " ghosts" << Qt::endl;
+    }
+    return 0;
+}
+
+static void addOptions(QCommandLineParser &parser)
+{
+    parser.addHelpOption();
+    parser.addOption({"headless", "Run the simulation without a window."});
+    parser.addOption({"maze", "Maze file to play (any size).", "file", ":/assets/map.txt"});
+    parser.addOption({"batch", "Play many games per round in parallel and print statistics."});
+    parser.addOption({"replay", "Play back a recorded session log (at full speed with --headless).", "file"});
+    parser.addOption({"seek", "Replay: jump to this tick.", "tick"});
+    parser.addOption({"ticks", "Number of game ticks to simulate.", "N", "10000"});
+    parser.addOption({"round", "Round (1-7) to play.", "round", "4"});
+    parser.addOption({"games", "Batch: games per round.", "N", "1000"});
+    parser.addOption({"max-ticks", "Batch: tick limit per game.", "N", "20000"});
+    parser.addOption({"threads", "Batch: worker threads (0 = all cores).", "N", "0"});
+    parser.addOption({"seed", "Seed for the first game.", "seed", "1"});
+    parser.addOption({"controller", "Batch: Pac-Man controller, random or greedy.", "name", "random"});
+}
 
 int main(int argc, char *argv[])
 {
+    // Headless and batch runs must not create a QApplication (it needs a
+    // display), so look for the flags before any application object exists.
+    bool headless = false;
+    bool batch = false;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (qstrcmp(argv[i], "--batch") == 0) {
+            batch = true;
+        }
+    }
+
+    if (headless || batch) {
+        QCoreApplication a(argc, argv);
+
+        QCommandLineParser parser;
+        addOptions(parser);
+        parser.process(a);
+
+        // Per-event qDebug() output would dominate the run time
+        QLoggingCategory::setFilterRules("*.debug=false");
+
+        if (batch) {
+            return runBatch(parser);
+        }
+        if (parser.isSet("replay")) {
+            return runReplay(parser);
+        }
+        return runHeadless(parser.value("maze"), parser.value("ticks").toLongLong(),
+                           qBound(1, parser.value("round").toInt(), 7),
+                           parser.value("seed").toULongLong());
+    }
+
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    addOptions(parser);
+    parser.process(a);
+
     GameWidget w; // <-- Create your GameWidget
+    if (parser.isSet("maze") && !w.loadMaze(parser.value("maze"))) {
+        return 1;
+    }
+    if (parser.isSet("replay") && !w.startReplay(parser.value("replay"))) {
+        return 1;
+    }
     w.show();       // <-- Show it
 
     return a.exec();
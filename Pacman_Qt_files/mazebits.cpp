@@ -0,0 +1,161 @@
+#include "mazebits.h"
+#include <QtAlgorithms>
+
+MazeBits::MazeBits()
+    : m_width(0),
+    m_height(0),
+    m_rowWords(0),
+    m_rowBits(0)
+{
+}
+
+MazeBits MazeBits::fromCells(const QByteArray &cells, int width, int height)
+{
+    MazeBits maze;
+    maze.m_width = width;
+    maze.m_height = height;
+    maze.m_rowWords = (width + 2 + 63) / 64;
+    maze.m_rowBits = maze.m_rowWords * 64;
+
+    // Walls start out solid, so the border and the row padding stay walls
+    const int words = (height + 2) * maze.m_rowWords;
+    maze.m_planes[Walls].fill(~quint64(0), words);
+    for (int plane = Pellets; plane < PlaneCount; ++plane) {
+        maze.m_planes[plane].fill(0, words);
+    }
+
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            int bit = maze.bitIndex(col, row);
+            quint64 mask = quint64(1) << (bit & 63);
+            int value = cells[row * width + col];
+            if (value != 1) maze.m_planes[Walls][bit >> 6] &= ~mask;
+            if (value == 0) maze.m_planes[Pellets][bit >> 6] |= mask;
+            if (value == 4) maze.m_planes[PowerPellets][bit >> 6] |= mask;
+            if (value == 2) maze.m_planes[Spawn][bit >> 6] |= mask;
+        }
+    }
+    return maze;
+}
+
+QByteArray MazeBits::toCells() const
+{
+    QByteArray cells(m_width * m_height, 0);
+    for (int row = 0; row < m_height; ++row) {
+        for (int col = 0; col < m_width; ++col) {
+            cells[row * m_width + col] = char(cellValue(col, row));
+        }
+    }
+    return cells;
+}
+
+int MazeBits::cellValue(int col, int row) const
+{
+    if (test(Walls, col, row)) return 1;
+    if (test(Pellets, col, row)) return 0;
+    if (test(PowerPellets, col, row)) return 4;
+    if (test(Spawn, col, row)) return 2;
+    return 3;
+}
+
+int MazeBits::count(Plane plane) const
+{
+    // Only the wall plane has bits in the border and padding, and nobody
+    // counts walls, so a flat popcount over the plane is exact
+    int total = 0;
+    for (const quint64 word : m_planes[plane]) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+QVector<QPoint> MazeBits::changedCells(const MazeBits &other, Plane plane) const
+{
+    QVector<QPoint> cells;
+    const quint64 *mine = m_planes[plane].constData();
+    const quint64 *theirs = other.m_planes[plane].constData();
+    if (mine == theirs) return cells;
+
+    const int words = m_planes[plane].size();
+    for (int w = 0; w < words; ++w) {
+        quint64 diff = mine[w] ^ theirs[w];
+        while (diff) {
+            const int bit = w * 64 + qCountTrailingZeroBits(diff);
+            diff &= diff - 1;
+            const int col = bit % m_rowBits - 1;
+            const int row = bit / m_rowBits - 1;
+            if (col >= 0 && col < m_width && row >= 0 && row < m_height) {
+                cells.append(QPoint(col, row));
+            }
+        }
+    }
+    return cells;
+}
+
+QByteArray MazeBits::exitMasks() const
+{
+    QByteArray masks(m_width * m_height, 0);
+    const quint64 *walls = m_planes[Walls].constData();
+
+    for (int row = 0; row < m_height; ++row) {
+        const quint64 *above = walls + row * m_rowWords;
+        const quint64 *here = above + m_rowWords;
+        const quint64 *below = here + m_rowWords;
+
+        for (int w = 0; w < m_rowWords; ++w) {
+            // Bit i of each word says whether the neighbour of padded column
+            // w * 64 + i is open; the horizontal ones borrow a bit from the
+            // adjacent word (the border keeps those in range)
+            const quint64 open = ~here[w];
+            const quint64 prev = w > 0 ? ~here[w - 1] : 0;
+            const quint64 next = w + 1 < m_rowWords ? ~here[w + 1] : 0;
+            const quint64 up = ~above[w] & open;
+            const quint64 down = ~below[w] & open;
+            const quint64 left = ((open << 1) | (prev >> 63)) & open;
+            const quint64 right = ((open >> 1) | (next << 63)) & open;
+            if (!(up | down | left | right)) continue;
+
+            // Scatter the four planes into per-cell bytes
+            const int firstCol = w * 64 - 1; // Padded column 0 is the border
+            for (int i = 0; i < 64; ++i) {
+                const int col = firstCol + i;
+                if (col < 0 || col >= m_width) continue;
+                masks[row * m_width + col] = char(((up >> i) & 1) | (((down >> i) & 1) << 1) |
+                                                  (((left >> i) & 1) << 2) | (((right >> i) & 1) << 3));
+            }
+        }
+    }
+    return masks;
+}
+
+QVector<CellInfo> MazeBits::cellInfo() const
+{
+    const QByteArray masks = exitMasks();
+    const int cells = m_width * m_height;
+    QVector<CellInfo> info(cells);
+    QVector<int> queue;
+    queue.reserve(cells);
+
+    // Junctions (3+ exits) are the BFS sources for the corridor distance
+    for (int i = 0; i < cells; ++i) {
+        quint8 exits = quint8(masks[i]);
+        bool junction = qPopulationCount(exits) >= 3;
+        info[i].flags = exits | (junction ? CELL_JUNCTION : 0);
+        info[i].corridor = junction ? 0 : 255;
+        if (junction) queue.append(i);
+    }
+
+    const int offset[4] = { -m_width, m_width, -1, 1 }; // Per Direction
+    for (int head = 0; head < queue.size(); ++head) {
+        const int current = queue[head];
+        if (info[current].corridor >= 254) continue; // Saturated, stop spreading
+        for (int dir = Up; dir <= Right; ++dir) {
+            if (!((info[current].flags >> dir) & 1)) continue;
+            int next = current + offset[dir];
+            if (info[next].corridor != 255) continue;
+            info[next].corridor = info[current].corridor + 1;
+            queue.append(next);
+        }
+    }
+    return info;
+}
@@ -0,0 +1,92 @@
+#ifndef MAZEBITS_H
+#define MAZEBITS_H
+
+#include <QByteArray>
+#include <QPoint>
+#include <QVector>
+#include <QtGlobal>
+
+#include "gametypes.h"
+
+// Exit mask bits, in Direction order
+#define EXIT_UP    0x1
+#define EXIT_DOWN  0x2
+#define EXIT_LEFT  0x4
+#define EXIT_RIGHT 0x8
+
+// Per-cell record built once per maze. 'flags' holds the EXIT_* bits and
+// CELL_JUNCTION, so a ghost decision is a single byte load. 'corridor' is
+// the walk to the nearest junction (0 on a junction, 255 if none or further).
+#define CELL_EXITS    0x0F
+#define CELL_JUNCTION 0x10
+
+struct CellInfo {
+    quint8 flags;
+    quint8 corridor;
+};
+
+// The maze as one bit per cell and plane.
+//
+// Every row is padded to whole 64-bit words and the maze has a one-cell
+// border of walls all round, so neighbour lookups need no bounds checks and
+// bulk operations (counting, exit masks, resets) handle 64 cells per word.
+// The shipped 29x20 map takes 22 words per plane.
+class MazeBits
+{
+public:
+    enum Plane { Walls, Pellets, PowerPellets, Spawn, PlaneCount };
+
+    MazeBits();
+
+    // Builds the planes from row-major cell values (0 pellet, 1 wall,
+    // 2 spawn, 3 empty, 4 power pellet), and back
+    static MazeBits fromCells(const QByteArray &cells, int width, int height);
+    QByteArray toCells() const;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    bool test(Plane plane, int col, int row) const
+    {
+        int bit = bitIndex(col, row);
+        return (m_planes[plane][bit >> 6] >> (bit & 63)) & 1;
+    }
+    void clear(Plane plane, int col, int row)
+    {
+        int bit = bitIndex(col, row);
+        m_planes[plane][bit >> 6] &= ~(quint64(1) << (bit & 63));
+    }
+
+    // Anything outside the maze counts as a wall
+    bool isWall(int col, int row) const
+    {
+        if (uint(col) >= uint(m_width) || uint(row) >= uint(m_height)) return true;
+        return test(Walls, col, row);
+    }
+
+    int cellValue(int col, int row) const;
+    int count(Plane plane) const;
+
+    // Cells (x = column, y = row) whose bit in 'plane' differs from the same
+    // sized 'other'. Free when the plane is still shared with 'other'.
+    QVector<QPoint> changedCells(const MazeBits &other, Plane plane) const;
+
+    // EXIT_* bits of the open neighbours of every cell (0 for walls),
+    // row-major. Computed a word of 64 cells at a time from shifted copies
+    // of the wall plane.
+    QByteArray exitMasks() const;
+
+    // CellInfo of every cell, row-major, from exitMasks()
+    QVector<CellInfo> cellInfo() const;
+
+private:
+    int bitIndex(int col, int row) const { return (row + 1) * m_rowBits + col + 1; }
+
+    int m_width;
+    int m_height;
+    int m_rowWords;                         // Words per padded row
+    int m_rowBits;                          // m_rowWords * 64
+    QVector<quint64> m_planes[PlaneCount];  // (height + 2) rows of m_rowWords
+};
+
+#endif // MAZEBITS_H
@@ -0,0 +1,204 @@
+#include "mazelayer.h"
+#include "scaledpixmap.h"
+#include <QtMath>
+
+MazeLayer::MazeLayer()
+    : m_scale(1.0),
+    m_chunkCols(0),
+    m_chunkRows(0)
+{
+}
+
+void MazeLayer::setSprites(const QPixmap &empty, const QPixmap &wall, const QPixmap &pellet, const QPixmap &powerPellet)
+{
+    m_emptySprite = empty;
+    m_wallSprite = wall;
+    m_pelletSprite = pellet;
+    m_powerPelletSprite = powerPellet;
+    scaleSprites();
+    m_chunks.clear();
+}
+
+void MazeLayer::setScale(qreal scale)
+{
+    if (qFuzzyCompare(scale, m_scale)) return;
+    m_scale = scale;
+    scaleSprites();
+    m_chunks.clear();
+}
+
+// Chunks are rendered at m_scale, so tiles pre-scaled to it draw as plain
+// copies; zooming back to an earlier scale finds them still cached
+void MazeLayer::scaleSprites()
+{
+    const QSize tile(TILE_SIZE, TILE_SIZE);
+    m_emptyTile = scaledPixmap(m_emptySprite, tile, m_scale, Qt::SmoothTransformation);
+    m_wallTile = scaledPixmap(m_wallSprite, tile, m_scale, Qt::SmoothTransformation);
+    m_pelletTile = scaledPixmap(m_pelletSprite, tile, m_scale, Qt::SmoothTransformation);
+    m_powerPelletTile = scaledPixmap(m_powerPelletSprite, tile, m_scale, Qt::SmoothTransformation);
+}
+
+void MazeLayer::sync(const MazeBits &maze)
+{
+    // A different maze: start over
+    if (maze.width() != m_maze.width() || maze.height() != m_maze.height() ||
+        !maze.changedCells(m_maze, MazeBits::Walls).isEmpty()) {
+        m_maze = maze;
+        m_chunkCols = (maze.width() + MAZE_CHUNK_TILES - 1) / MAZE_CHUNK_TILES;
+        m_chunkRows = (maze.height() + MAZE_CHUNK_TILES - 1) / MAZE_CHUNK_TILES;
+        m_chunks.clear();
+        return;
+    }
+
+    const QVector<QPoint> changed = maze.changedCells(m_maze, MazeBits::Pellets) +
+                                    maze.changedCells(m_maze, MazeBits::PowerPellets);
+    m_maze = maze;
+    if (changed.size() > MAZE_CHUNK_TILES * MAZE_CHUNK_TILES) {
+        // Pellets put back for a new round; redraw them as they come into view
+        for (Chunk &chunk : m_chunks) {
+            chunk.pellets = QImage();
+        }
+        return;
+    }
+    for (const QPoint &cell : changed) {
+        updatePelletTile(cell);
+    }
+}
+
+// Columns and rows of the chunks that 'visible' touches (empty if none)
+QRect MazeLayer::chunkRange(const QRect &visible) const
+{
+    const int chunkPixels = MAZE_CHUNK_TILES * TILE_SIZE;
+    const int firstCol = qMax(0, visible.left() / chunkPixels);
+    const int firstRow = qMax(0, visible.top() / chunkPixels);
+    const int lastCol = qMin(m_chunkCols - 1, visible.right() / chunkPixels);
+    const int lastRow = qMin(m_chunkRows - 1, visible.bottom() / chunkPixels);
+    return QRect(QPoint(firstCol, firstRow), QPoint(lastCol, lastRow));
+}
+
+void MazeLayer::prepare(const QRect &visible)
+{
+    if (m_chunkCols == 0 || m_chunkRows == 0) return;
+
+    const QRect range = chunkRange(visible);
+    const int firstCol = range.left();
+    const int firstRow = range.top();
+    const int lastCol = range.right();
+    const int lastRow = range.bottom();
+    for (int chunkRow = firstRow; chunkRow <= lastRow; ++chunkRow) {
+        for (int chunkCol = firstCol; chunkCol <= lastCol; ++chunkCol) {
+            renderChunk(chunkCol, chunkRow);
+        }
+    }
+
+    // Keep a chunk of margin for scrolling back and forth, drop the rest
+    if (m_chunks.size() > (lastCol - firstCol + 3) * (lastRow - firstRow + 3)) {
+        for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+            const int chunkCol = it.key() % m_chunkCols;
+            const int chunkRow = it.key() / m_chunkCols;
+            if (chunkCol < firstCol - 1 || chunkCol > lastCol + 1 ||
+                chunkRow < firstRow - 1 || chunkRow > lastRow + 1) {
+                it = m_chunks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void MazeLayer::draw(QPainter &painter, const QRect &visible) const
+{
+    if (m_chunkCols == 0 || m_chunkRows == 0) return;
+
+    const int chunkPixels = MAZE_CHUNK_TILES * TILE_SIZE;
+    const QRect range = chunkRange(visible);
+    for (int chunkRow = range.top(); chunkRow <= range.bottom(); ++chunkRow) {
+        for (int chunkCol = range.left(); chunkCol <= range.right(); ++chunkCol) {
+            auto it = m_chunks.constFind(chunkKey(chunkCol, chunkRow));
+            if (it == m_chunks.constEnd()) continue;
+            const QPoint pos(chunkCol * chunkPixels, chunkRow * chunkPixels);
+            painter.drawImage(pos, it->floor);
+            painter.drawImage(pos, it->pellets);
+        }
+    }
+}
+
+// Renders whichever layers of a chunk are missing
+void MazeLayer::renderChunk(int chunkCol, int chunkRow)
+{
+    Chunk &layers = m_chunks[chunkKey(chunkCol, chunkRow)];
+    const int firstCol = chunkCol * MAZE_CHUNK_TILES;
+    const int firstRow = chunkRow * MAZE_CHUNK_TILES;
+    const int lastCol = qMin(m_maze.width(), firstCol + MAZE_CHUNK_TILES) - 1;
+    const int lastRow = qMin(m_maze.height(), firstRow + MAZE_CHUNK_TILES) - 1;
+
+    if (layers.floor.isNull()) {
+        layers.floor = newLayer(chunkCol, chunkRow, false);
+        QPainter painter(&layers.floor);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                drawFloorTile(painter, col, row, QPoint(col - firstCol, row - firstRow) * TILE_SIZE);
+            }
+        }
+    }
+
+    if (layers.pellets.isNull()) {
+        layers.pellets = newLayer(chunkCol, chunkRow, true);
+        QPainter painter(&layers.pellets);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                drawPelletTile(painter, col, row, QPoint(col - firstCol, row - firstRow) * TILE_SIZE);
+            }
+        }
+    }
+}
+
+// An empty layer for one chunk, with enough device pixels that blitting it
+// at m_scale needs no scaling
+QImage MazeLayer::newLayer(int chunkCol, int chunkRow, bool transparent) const
+{
+    const int cols = qMin(MAZE_CHUNK_TILES, m_maze.width() - chunkCol * MAZE_CHUNK_TILES);
+    const int rows = qMin(MAZE_CHUNK_TILES, m_maze.height() - chunkRow * MAZE_CHUNK_TILES);
+    QImage layer(qCeil(cols * TILE_SIZE * m_scale), qCeil(rows * TILE_SIZE * m_scale),
+                 transparent ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    layer.setDevicePixelRatio(m_scale);
+    layer.fill(transparent ? Qt::transparent : Qt::black);
+    return layer;
+}
+
+void MazeLayer::drawFloorTile(QPainter &painter, int col, int row, QPoint origin)
+{
+    painter.drawPixmap(origin, m_emptyTile);
+    if (m_maze.test(MazeBits::Walls, col, row)) {
+        painter.drawPixmap(origin, m_wallTile);
+    }
+}
+
+void MazeLayer::drawPelletTile(QPainter &painter, int col, int row, QPoint origin)
+{
+    const int cell = m_maze.cellValue(col, row);
+    if (cell == 0) {
+        painter.drawPixmap(origin, m_pelletTile);
+    } else if (cell == 4) {
+        painter.drawPixmap(origin, m_powerPelletTile);
+    }
+}
+
+// Redraws one tile of the pellet layer, if its chunk is rendered at all
+void MazeLayer::updatePelletTile(QPoint cell)
+{
+    const int chunkCol = cell.x() / MAZE_CHUNK_TILES;
+    const int chunkRow = cell.y() / MAZE_CHUNK_TILES;
+    auto it = m_chunks.find(chunkKey(chunkCol, chunkRow));
+    if (it == m_chunks.end() || it->pellets.isNull()) return;
+
+    const QPoint origin = QPoint(cell.x() - chunkCol * MAZE_CHUNK_TILES,
+                                 cell.y() - chunkRow * MAZE_CHUNK_TILES) * TILE_SIZE;
+    QPainter painter(&it->pellets);
+    painter.setCompositionMode(QPainter::CompositionMode_Clear);
+    painter.fillRect(QRect(origin, QSize(TILE_SIZE, TILE_SIZE)), Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    drawPelletTile(painter, cell.x(), cell.y(), origin);
+}
@@ -0,0 +1,79 @@
+#ifndef MAZELAYER_H
+#define MAZELAYER_H
+
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+
+#include "mazebits.h"
+
+// Maze tiles per side of one cached chunk
+#define MAZE_CHUNK_TILES 16
+
+// The maze as pre-rendered layers, so a frame blits a few images instead
+// of drawing every visible tile.
+//
+// Floor and walls go into one opaque layer, pellets into a transparent one
+// on top. Both are cut into chunks of MAZE_CHUNK_TILES square, rendered the
+// first time they come into view at the painter's final scale, and dropped
+// again once they are well out of view, so any maze size costs memory for
+// about one screen. Eating a pellet redraws just that tile of the pellet
+// layer; new sprites, a new scale or a new maze throw everything away.
+//
+// The layers are QImages, so once prepare()d, draw() may run on several
+// threads at once.
+class MazeLayer
+{
+public:
+    MazeLayer();
+
+    void setSprites(const QPixmap &empty, const QPixmap &wall, const QPixmap &pellet, const QPixmap &powerPellet);
+
+    // Device pixels per maze pixel (zoom times the screen's pixel ratio)
+    void setScale(qreal scale);
+
+    // Brings the layers up to date with 'maze'
+    void sync(const MazeBits &maze);
+
+    // Renders the chunks 'visible' (in maze pixels) needs and drops those
+    // well out of view
+    void prepare(const QRect &visible);
+
+    // Draws the part of the maze inside 'visible', which prepare() must
+    // have covered, with the painter already set up in maze coordinates
+    void draw(QPainter &painter, const QRect &visible) const;
+
+private:
+    struct Chunk {
+        QImage floor;
+        QImage pellets;
+    };
+
+    void renderChunk(int chunkCol, int chunkRow);
+    QImage newLayer(int chunkCol, int chunkRow, bool transparent) const;
+    QRect chunkRange(const QRect &visible) const;
+    void drawFloorTile(QPainter &painter, int col, int row, QPoint origin);
+    void drawPelletTile(QPainter &painter, int col, int row, QPoint origin);
+    void updatePelletTile(QPoint cell);
+    void scaleSprites();
+    int chunkKey(int chunkCol, int chunkRow) const { return chunkRow * m_chunkCols + chunkCol; }
+
+    QPixmap m_emptySprite;
+    QPixmap m_wallSprite;
+    QPixmap m_pelletSprite;
+    QPixmap m_powerPelletSprite;
+    QPixmap m_emptyTile;              // The sprites above, pre-scaled to m_scale
+    QPixmap m_wallTile;
+    QPixmap m_pelletTile;
+    QPixmap m_powerPelletTile;
+    qreal m_scale;
+
+    MazeBits m_maze;                  // What the layers show
+    int m_chunkCols;
+    int m_chunkRows;
+    QHash<int, Chunk> m_chunks;       // By chunkKey()
+};
+
+#endif // MAZELAYER_H
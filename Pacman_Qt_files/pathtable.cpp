@@ -0,0 +1,280 @@
+#include "pathtable.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <cstring>
+
+#define PATH_CACHE_MAGIC 0x504D5054 // "PMPT"
+
+// Fixed-size header at the start of a cache file, followed directly by the
+// table bytes. Host byte order: the cache never leaves the machine.
+struct PathCacheHeader {
+    quint32 magic;
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 nodeCount;
+    qint32 rowStride;
+    qint64 tableBytes;
+    quint64 checksum;
+    char mazeKey[32];
+};
+
+#define PATH_CACHE_FULL_CHECK_BYTES (4 * 1024 * 1024) // Tables up to this are hashed whole
+#define PATH_CACHE_SAMPLE_STRIDE (64 * 1024)          // Beyond it, table bytes per hashed word
+
+static quint64 mixChecksum(quint64 hash, const char *data, qint64 size)
+{
+    qint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ quint8(data[i])) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Checksum of the header and the table. A table of up to
+// PATH_CACHE_FULL_CHECK_BYTES is hashed whole, which takes well under a
+// millisecond, so any damage to it is caught. A bigger one is only sampled,
+// one word every PATH_CACHE_SAMPLE_STRIDE bytes plus the last word, so a
+// load faults in a few pages instead of the whole table; damage between
+// samples goes unnoticed there.
+static quint64 cacheChecksum(const PathCacheHeader &header, const char *table)
+{
+    PathCacheHeader fields = header;
+    fields.checksum = 0;
+    quint64 hash = mixChecksum(0xcbf29ce484222325ull, reinterpret_cast<const char *>(&fields), sizeof(fields));
+    if (header.tableBytes <= PATH_CACHE_FULL_CHECK_BYTES) {
+        return mixChecksum(hash, table, header.tableBytes);
+    }
+    for (qint64 i = 0; i < header.tableBytes; i += PATH_CACHE_SAMPLE_STRIDE) {
+        hash = mixChecksum(hash, table + i, qMin<qint64>(8, header.tableBytes - i));
+    }
+    return mixChecksum(hash, table + header.tableBytes - 8, 8);
+}
+
+PathTable::PathTable()
+    : m_width(0),
+    m_height(0),
+    m_nodeCount(0),
+    m_rowStride(0)
+{
+}
+
+void PathTable::clear()
+{
+    m_width = 0;
+    m_height = 0;
+    m_nodeCount = 0;
+    m_rowStride = 0;
+    m_cellToId.clear();
+    m_component.clear();
+    m_table.clear();
+    m_mappedFile.reset();
+}
+
+void PathTable::build(const QByteArray &walls, int width, int height, const QString &cacheDir)
+{
+    qDebug() << "Starting path pre-computation...";
+    QElapsedTimer timer;
+    timer.start();
+
+    clear();
+    m_width = width;
+    m_height = height;
+
+    // 1. Map all valid (non-wall) cells to a dense id
+    m_cellToId.fill(-1, width * height);
+    QVector<QPoint> idToCell;
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            if (!walls[r * width + c]) {
+                m_cellToId[r * width + c] = idToCell.size();
+                idToCell.append(QPoint(c, r));
+            }
+        }
+    }
+
+    m_nodeCount = idToCell.size();
+    if (m_nodeCount == 0) return;
+
+    // 2. Neighbour ids per node in Direction order (Up, Down, Left, Right;
+    //    -1 = wall or edge), so the BFS never touches the grid
+    QVector<int> neighbours(m_nodeCount * 4, -1);
+    for (int id = 0; id < m_nodeCount; ++id) {
+        const QPoint p = idToCell[id];
+        neighbours[id * 4 + Up] = cellId(p.x(), p.y() - 1);
+        neighbours[id * 4 + Down] = cellId(p.x(), p.y() + 1);
+        neighbours[id * 4 + Left] = cellId(p.x() - 1, p.y());
+        neighbours[id * 4 + Right] = cellId(p.x() + 1, p.y());
+    }
+
+    // 3. Connected regions, so unreachable targets answer Stop instead of
+    //    whatever bits happen to be in the table
+    m_component.fill(-1, m_nodeCount);
+    QVector<int> queue(m_nodeCount);
+    int components = 0;
+    for (int seed = 0; seed < m_nodeCount; ++seed) {
+        if (m_component[seed] != -1) continue;
+        int head = 0, tail = 0;
+        queue[tail++] = seed;
+        m_component[seed] = components;
+        while (head < tail) {
+            int current = queue[head++];
+            for (int n = 0; n < 4; ++n) {
+                int neighbour = neighbours[current * 4 + n];
+                if (neighbour >= 0 && m_component[neighbour] == -1) {
+                    m_component[neighbour] = components;
+                    queue[tail++] = neighbour;
+                }
+            }
+        }
+        components++;
+    }
+
+    // 4. Reuse the table from a previous run of the same maze if we can
+    m_rowStride = (m_nodeCount + 3) / 4;
+    QString cacheFile;
+    QByteArray key;
+    if (!cacheDir.isEmpty()) {
+        key = mazeKey(walls, width, height);
+        cacheFile = cacheDir + "/paths-" + QString::fromLatin1(key.toHex().left(32)) + ".bin";
+        if (loadCache(cacheFile, key)) {
+            qDebug() << "Path table for" << m_nodeCount << "nodes mapped from" << cacheFile << "in"
+                     << timer.elapsed() << "ms";
+            return;
+        }
+    }
+
+    // 5. Run a BFS from *every* node. Each discovered node inherits the
+    //    first direction of the node it was reached from, so every source is
+    //    O(N + E). Sources only write their own row, so they run in parallel.
+    m_table = QByteArray(qint64(m_nodeCount) * m_rowStride, 0);
+
+    QVector<int> sources(m_nodeCount);
+    for (int i = 0; i < m_nodeCount; ++i) {
+        sources[i] = i;
+    }
+    quint8 *table = reinterpret_cast<quint8 *>(m_table.data());
+    const int *adjacent = neighbours.constData();
+    const int nodeCount = m_nodeCount;
+    const int rowStride = m_rowStride;
+
+    QtConcurrent::blockingMap(sources, [=](int startId) {
+        QVector<int> bfsQueue(nodeCount);
+        QVector<qint8> firstDir(nodeCount, -1); // -1 = not visited yet
+        quint8 *row = table + qint64(startId) * rowStride;
+
+        int head = 0, tail = 0;
+        bfsQueue[tail++] = startId;
+        firstDir[startId] = Stop;
+
+        while (head < tail) {
+            int current = bfsQueue[head++];
+            for (int n = 0; n < 4; ++n) {
+                int neighbour = adjacent[current * 4 + n];
+                if (neighbour < 0 || firstDir[neighbour] != -1) continue;
+
+                // Neighbours of the start are reached by their own direction
+                qint8 dir = (current == startId) ? qint8(n) : firstDir[current];
+                firstDir[neighbour] = dir;
+                row[neighbour >> 2] |= quint8(dir << ((neighbour & 3) * 2));
+                bfsQueue[tail++] = neighbour;
+            }
+        }
+    });
+
+    qDebug() << "Path pre-computation complete. " << m_nodeCount << "nodes," << m_table.size()
+             << "table bytes, in" << timer.elapsed() << "ms";
+
+    if (!cacheFile.isEmpty()) {
+        QDir().mkpath(cacheDir);
+        saveCache(cacheFile, key);
+    }
+}
+
+// === DISK CACHE ===
+
+QByteArray PathTable::mazeKey(const QByteArray &walls, int width, int height)
+{
+    // Only the walls shape the table; pellets and spawn points don't matter
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    qint32 header[3] = { PATH_TABLE_FORMAT_VERSION, width, height };
+    hash.addData(QByteArray::fromRawData(reinterpret_cast<const char *>(header), sizeof(header)));
+    hash.addData(walls);
+    return hash.result();
+}
+
+bool PathTable::loadCache(const QString &path, const QByteArray &key)
+{
+    QSharedPointer<QFile> file(new QFile(path));
+    if (!file->exists() || !file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 expectedTable = qint64(m_nodeCount) * m_rowStride;
+    if (file->size() != qint64(sizeof(PathCacheHeader)) + expectedTable) {
+        qDebug() << "Path cache" << path << "has the wrong size, rebuilding";
+        return false;
+    }
+
+    uchar *mapped = file->map(0, file->size());
+    if (!mapped) {
+        return false;
+    }
+
+    PathCacheHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    const char *table = reinterpret_cast<const char *>(mapped) + sizeof(PathCacheHeader);
+    if (header.magic != PATH_CACHE_MAGIC || header.version != PATH_TABLE_FORMAT_VERSION ||
+        header.width != m_width || header.height != m_height || header.nodeCount != m_nodeCount ||
+        header.rowStride != m_rowStride || header.tableBytes != expectedTable ||
+        memcmp(header.mazeKey, key.constData(), sizeof(header.mazeKey)) != 0) {
+        qDebug() << "Path cache" << path << "is stale, rebuilding";
+        return false;
+    }
+    if (cacheChecksum(header, table) != header.checksum) {
+        qDebug() << "Path cache" << path << "is corrupt, rebuilding";
+        return false;
+    }
+
+    // Point straight into the mapping: no copy, no parsing
+    file->close(); // The mapping stays valid until the QFile is destroyed
+    m_table = QByteArray::fromRawData(table, expectedTable);
+    m_mappedFile = file;
+    return true;
+}
+
+bool PathTable::saveCache(const QString &path, const QByteArray &key) const
+{
+    PathCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PATH_CACHE_MAGIC;
+    header.version = PATH_TABLE_FORMAT_VERSION;
+    header.width = m_width;
+    header.height = m_height;
+    header.nodeCount = m_nodeCount;
+    header.rowStride = m_rowStride;
+    header.tableBytes = m_table.size();
+    memcpy(header.mazeKey, key.constData(), qMin<qsizetype>(key.size(), sizeof(header.mazeKey)));
+    header.checksum = cacheChecksum(header, m_table.constData());
+
+    // QSaveFile only replaces the old cache once everything is written, so
+    // a crash mid-write never leaves a half-written table behind
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Could not write path cache" << path;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(m_table);
+    return file.commit();
+}
@@ -0,0 +1,84 @@
+#ifndef PATHTABLE_H
+#define PATHTABLE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "gametypes.h"
+
+// All-pairs "which way do I go first" table for the ghosts.
+//
+// Every walkable cell gets a dense id through a flat row*width+col array.
+// Row 'from' of the table holds, for every target id, the first direction
+// of a shortest path packed into 2 bits (Up, Down, Left, Right), so a ghost
+// decision is two array loads and a shift. Rows are padded to whole bytes so
+// rows can be built in parallel without sharing a byte.
+//
+// Built tables are cached on disk, keyed by a hash of the walls and the
+// table format, and memory-mapped straight back on the next start.
+#define PATH_TABLE_FORMAT_VERSION 2
+#define PATH_TABLE_MAX_BYTES (64 * 1024 * 1024) // Bigger mazes use ClusterPaths
+
+class PathTable
+{
+public:
+    PathTable();
+
+    // 'walls' holds width*height bytes, non-zero for a wall. With a
+    // 'cacheDir' the table is mapped from there if a valid cache exists,
+    // and written there after building otherwise.
+    void build(const QByteArray &walls, int width, int height, const QString &cacheDir = QString());
+    void clear();
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int nodeCount() const { return m_nodeCount; }
+    qint64 tableBytes() const { return m_table.size(); }
+    bool isMapped() const { return !m_mappedFile.isNull(); }
+
+    // Size of the table for a maze with 'nodeCount' walkable cells
+    static qint64 tableBytesFor(int nodeCount) { return qint64(nodeCount) * ((nodeCount + 3) / 4); }
+
+    // Dense id of a cell, -1 for walls and out-of-bounds cells
+    int cellId(int col, int row) const
+    {
+        if (col < 0 || col >= m_width || row < 0 || row >= m_height) return -1;
+        return m_cellToId[row * m_width + col];
+    }
+
+    // First move on a shortest path, Stop if already there or unreachable
+    Direction nextDirection(int fromId, int toId) const
+    {
+        if (fromId == toId || m_component[fromId] != m_component[toId]) return Stop;
+        quint8 packed = quint8(m_table[qint64(fromId) * m_rowStride + (toId >> 2)]);
+        return Direction((packed >> ((toId & 3) * 2)) & 0x3);
+    }
+
+    Direction nextDirection(QPoint fromCell, QPoint toCell) const
+    {
+        int fromId = cellId(fromCell.x(), fromCell.y());
+        int toId = cellId(toCell.x(), toCell.y());
+        if (fromId < 0 || toId < 0) return Stop;
+        return nextDirection(fromId, toId);
+    }
+
+private:
+    static QByteArray mazeKey(const QByteArray &walls, int width, int height);
+    bool loadCache(const QString &path, const QByteArray &key);
+    bool saveCache(const QString &path, const QByteArray &key) const;
+
+    int m_width;
+    int m_height;
+    int m_nodeCount;
+    int m_rowStride;              // Bytes per table row: 4 targets per byte
+    QVector<int> m_cellToId;      // row * width + col -> id, -1 for walls
+    QVector<int> m_component;     // Connected region of each id
+    QByteArray m_table;           // nodeCount rows of m_rowStride bytes
+    QSharedPointer<QFile> m_mappedFile; // Keeps a cache mapping alive while m_table points into it
+};
+
+#endif // PATHTABLE_H
@@ -0,0 +1,93 @@
+#include "pixelframe.h"
+#include <QPainter>
+#include <cstring>
+
+// Frame pixels per side of a maze tile
+#define PIXEL_TILE (TILE_SIZE / PIXEL_SIZE)
+
+PixelFrame::PixelFrame()
+{
+}
+
+// Samples the sprites down to one PIXEL_TILE square per Pattern. Walls are
+// plain blue, as pixel mode has always drawn them.
+void PixelFrame::setSprites(const QPixmap &empty, const QPixmap &pellet, const QPixmap &powerPellet)
+{
+    m_patterns = QImage(PIXEL_TILE * PatternCount, PIXEL_TILE, QImage::Format_RGB32);
+    m_patterns.fill(Qt::black);
+
+    QPainter painter(&m_patterns);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    for (int pattern = Floor; pattern < PatternCount; ++pattern) {
+        const QRect cell(pattern * PIXEL_TILE, 0, PIXEL_TILE, PIXEL_TILE);
+        if (pattern == Wall) {
+            painter.fillRect(cell, QColor(0, 0, 255));
+            continue;
+        }
+        painter.drawPixmap(cell, empty);
+        if (pattern == Pellet) {
+            painter.drawPixmap(cell, pellet);
+        } else if (pattern == PowerPellet) {
+            painter.drawPixmap(cell, powerPellet);
+        }
+    }
+}
+
+void PixelFrame::begin(const MazeBits &maze, const QRect &visible)
+{
+    // Whole frame pixels covering 'visible'
+    m_origin = QPoint(visible.left() / PIXEL_SIZE, visible.top() / PIXEL_SIZE);
+    const QSize size(visible.right() / PIXEL_SIZE - m_origin.x() + 1,
+                     visible.bottom() / PIXEL_SIZE - m_origin.y() + 1);
+    if (m_frame.size() != size) {
+        m_frame = QImage(size, QImage::Format_RGB32);
+    }
+    m_frame.fill(Qt::black);
+
+    const int firstCol = m_origin.x() / PIXEL_TILE;
+    const int firstRow = m_origin.y() / PIXEL_TILE;
+    const int lastCol = qMin(maze.width() - 1, (m_origin.x() + size.width() - 1) / PIXEL_TILE);
+    const int lastRow = qMin(maze.height() - 1, (m_origin.y() + size.height() - 1) / PIXEL_TILE);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            Pattern pattern = Floor;
+            switch (maze.cellValue(col, row)) {
+            case 1: pattern = Wall; break;
+            case 0: pattern = Pellet; break;
+            case 4: pattern = PowerPellet; break;
+            default: break;
+            }
+            copy(m_patterns, QRect(pattern * PIXEL_TILE, 0, PIXEL_TILE, PIXEL_TILE),
+                 QPoint(col, row) * PIXEL_TILE - m_origin, false);
+        }
+    }
+}
+
+void PixelFrame::drawSprite(const QImage &sheet, const QRect &cell, QPoint center)
+{
+    const QPoint topLeft(center.x() / PIXEL_SIZE - cell.width() / 2, center.y() / PIXEL_SIZE - cell.height() / 2);
+    copy(sheet, cell, topLeft - m_origin, true);
+}
+
+// Copies 'sourceRect' of a 32-bit 'source' to 'to' in the frame, clipped to
+// the frame. Keyed copies skip pixels less than half opaque.
+void PixelFrame::copy(const QImage &source, const QRect &sourceRect, QPoint to, bool keyed)
+{
+    const QRect dest = QRect(to, sourceRect.size()).intersected(m_frame.rect());
+    if (dest.isEmpty()) return;
+
+    const QPoint from = sourceRect.topLeft() + (dest.topLeft() - to);
+    for (int y = 0; y < dest.height(); ++y) {
+        const QRgb *in = reinterpret_cast<const QRgb *>(source.constScanLine(from.y() + y)) + from.x();
+        QRgb *out = reinterpret_cast<QRgb *>(m_frame.scanLine(dest.y() + y)) + dest.x();
+        if (!keyed) {
+            std::memcpy(out, in, dest.width() * sizeof(QRgb));
+            continue;
+        }
+        for (int x = 0; x < dest.width(); ++x) {
+            if (qAlpha(in[x]) >= 128) {
+                out[x] = in[x] | 0xff000000;
+            }
+        }
+    }
+}
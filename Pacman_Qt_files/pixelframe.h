@@ -0,0 +1,48 @@
+#ifndef PIXELFRAME_H
+#define PIXELFRAME_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QRect>
+
+#include "mazebits.h"
+
+// Maze pixels per pixel of pixel mode's framebuffer
+#define PIXEL_SIZE 4
+
+// Pixel mode's game field, at a quarter of the maze's resolution.
+//
+// A frame is written straight into one small QImage, with no QPainter:
+// maze tiles are row copies of pre-sampled patterns, actors colour-keyed
+// copies of sprite atlas cells. The caller shows it scaled up PIXEL_SIZE
+// times without smoothing, so every pixel on screen is a solid block.
+class PixelFrame
+{
+public:
+    PixelFrame();
+
+    void setSprites(const QPixmap &empty, const QPixmap &pellet, const QPixmap &powerPellet);
+
+    // Starts a frame showing 'visible' (in maze pixels) of 'maze'
+    void begin(const MazeBits &maze, const QRect &visible);
+
+    // Draws a 'cell' of 'sheet', already at frame resolution, centred on
+    // 'center' (in maze pixels). Pixels less than half opaque are skipped.
+    void drawSprite(const QImage &sheet, const QRect &cell, QPoint center);
+
+    const QImage &image() const { return m_frame; }
+
+    // Where image() goes, in maze pixels
+    QRect target() const { return QRect(m_origin * PIXEL_SIZE, m_frame.size() * PIXEL_SIZE); }
+
+private:
+    enum Pattern { Floor, Wall, Pellet, PowerPellet, PatternCount };
+
+    void copy(const QImage &source, const QRect &sourceRect, QPoint to, bool keyed);
+
+    QImage m_patterns;                // Pattern tiles side by side
+    QImage m_frame;
+    QPoint m_origin;                  // Top-left of the frame, in frame pixels
+};
+
+#endif // PIXELFRAME_H
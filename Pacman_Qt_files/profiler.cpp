@@ -0,0 +1,125 @@
+#include "profiler.h"
+#include <QFile>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+
+// === TIMING HISTOGRAM ===
+
+TimingHistogram::TimingHistogram()
+    : m_count(0),
+    m_maxNs(0)
+{
+    for (QAtomicInteger<quint32> &bucket : m_buckets) {
+        bucket.storeRelaxed(0);
+    }
+}
+
+void TimingHistogram::record(qint64 ns)
+{
+    // One writer, so plain relaxed loads and stores are enough
+    QAtomicInteger<quint32> &bucket = m_buckets[bucketOf(ns)];
+    bucket.storeRelaxed(bucket.loadRelaxed() + 1);
+    m_count.storeRelaxed(m_count.loadRelaxed() + 1);
+    if (ns > m_maxNs.loadRelaxed()) {
+        m_maxNs.storeRelaxed(ns);
+    }
+}
+
+qint64 TimingHistogram::percentileNs(double p) const
+{
+    const quint64 total = count();
+    if (total == 0) return 0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(p * total + 0.5));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS; ++bucket) {
+        seen += m_buckets[bucket].loadRelaxed();
+        if (seen >= rank) {
+            // The last bucket is open-ended
+            return (bucket == PROFILE_BUCKETS - 1) ? maxNs() : qMin(bucketLimitNs(bucket), maxNs());
+        }
+    }
+    return maxNs();
+}
+
+// Values below PROFILE_SUB_BUCKETS get a bucket each; above that, every
+// power of two is split into PROFILE_SUB_BUCKETS by the next two bits
+int TimingHistogram::bucketOf(qint64 ns)
+{
+    if (ns < PROFILE_SUB_BUCKETS) return int(qMax<qint64>(0, ns));
+
+    const int msb = 63 - qCountLeadingZeroBits(quint64(ns));
+    const int sub = int(ns >> (msb - 2)) & (PROFILE_SUB_BUCKETS - 1);
+    return qMin(PROFILE_BUCKETS - 1, (msb - 1) * PROFILE_SUB_BUCKETS + sub);
+}
+
+// Largest value that lands in 'bucket'
+qint64 TimingHistogram::bucketLimitNs(int bucket)
+{
+    if (bucket < PROFILE_SUB_BUCKETS) return bucket;
+
+    const int msb = bucket / PROFILE_SUB_BUCKETS + 1;
+    const int sub = bucket % PROFILE_SUB_BUCKETS;
+    return (qint64(PROFILE_SUB_BUCKETS + sub + 1) << (msb - 2)) - 1;
+}
+
+// === PROFILER ===
+
+Profiler::Profiler()
+    : m_droppedFrames(0)
+{
+}
+
+void Profiler::frameShown(qint64 intervalNs, qint64 expectedNs)
+{
+    m_histograms[FrameInterval].record(intervalNs);
+
+    // Half a frame late is jitter; beyond that, whole frames were missed
+    if (expectedNs > 0 && intervalNs > expectedNs * 3 / 2) {
+        const quint64 missed = quint64((intervalNs + expectedNs / 2) / expectedNs - 1);
+        m_droppedFrames.storeRelaxed(m_droppedFrames.loadRelaxed() + missed);
+    }
+}
+
+const char *Profiler::metricName(Metric metric)
+{
+    static const char *names[MetricCount] = {
+        "tick", "ghost_step", "collisions", "paint", "socket", "frame_interval"
+    };
+    return names[metric];
+}
+
+// Quotes a CSV field if it needs it
+static QString csvField(const QString &text)
+{
+    if (!text.contains(',') && !text.contains('"')) return text;
+    QString quoted = text;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+bool Profiler::writeCsv(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    const QString machine = QString("%1,%2,%3,%4").arg(csvField(QSysInfo::machineHostName()),
+                                                        csvField(QSysInfo::prettyProductName()),
+                                                        csvField(QSysInfo::currentCpuArchitecture()))
+                                .arg(QThread::idealThreadCount());
+    auto us = [](qint64 ns) { return QString::number(ns / 1000.0, 'f', 1); };
+
+    QTextStream out(&file);
+    out << "host,os,cpu,cores,metric,samples,p50_us,p90_us,p99_us,max_us\n";
+    for (int metric = 0; metric < MetricCount; ++metric) {
+        const TimingHistogram &h = m_histograms[metric];
+        out << machine << ',' << metricName(Metric(metric)) << ',' << h.count() << ','
+            << us(h.percentileNs(0.5)) << ',' << us(h.percentileNs(0.9)) << ','
+            << us(h.percentileNs(0.99)) << ',' << us(h.maxNs()) << '\n';
+    }
+    out << machine << ",dropped_frames," << droppedFrames() << ",,,,\n";
+    return true;
+}
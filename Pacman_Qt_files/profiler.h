@@ -0,0 +1,102 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QString>
+
+// Histogram buckets: PROFILE_SUB_BUCKETS per power of two of nanoseconds,
+// up to over half an hour. A bucket spans at most a quarter of its value.
+#define PROFILE_SUB_BUCKETS 4
+#define PROFILE_BUCKETS     (40 * PROFILE_SUB_BUCKETS)
+
+// Durations in log-scale buckets. Lock-free: one thread records, and any
+// thread may read at any time without holding it up. Counters are
+// relaxed atomics, so a reader can see a recording half done; that is
+// one sample off, which percentiles can live with.
+class TimingHistogram
+{
+public:
+    TimingHistogram();
+
+    void record(qint64 ns);
+
+    quint64 count() const { return m_count.loadRelaxed(); }
+    qint64 maxNs() const { return m_maxNs.loadRelaxed(); }
+
+    // Upper bound of the bucket holding the p-th fraction of samples
+    // (0.5 for the median), 0 with no samples
+    qint64 percentileNs(double p) const;
+
+private:
+    static int bucketOf(qint64 ns);
+    static qint64 bucketLimitNs(int bucket);
+
+    QAtomicInteger<quint32> m_buckets[PROFILE_BUCKETS];
+    QAtomicInteger<quint64> m_count;
+    QAtomicInteger<qint64> m_maxNs;
+};
+
+// Hot-path timings for the in-game overlay and the per-session CSV.
+//
+// Each metric is recorded by one thread only: the game tick and its parts
+// on the simulation thread, painting, input and frame pacing on the GUI
+// thread. Anyone may read. Nothing is timed unless a Profiler is handed
+// in (see GameCore::setProfiler()), so headless and batch runs pay nothing.
+class Profiler
+{
+public:
+    enum Metric {
+        // Simulation thread
+        Tick,            // GameCore::step()
+        GhostStep,       // GameCore::ghostAnimationStep()
+        Collisions,      // GameCore::checkGhostCollisions()
+        // GUI thread
+        Paint,           // GameWidget::drawGame()
+        Socket,          // Head pose commands
+        FrameInterval,   // Between frame loop wake-ups
+        MetricCount
+    };
+
+    Profiler();
+
+    TimingHistogram &histogram(Metric metric) { return m_histograms[metric]; }
+    const TimingHistogram &histogram(Metric metric) const { return m_histograms[metric]; }
+
+    // Records a frame loop wake-up 'intervalNs' after the last one, and
+    // counts the frames it skipped if that is well over 'expectedNs'
+    void frameShown(qint64 intervalNs, qint64 expectedNs);
+    quint64 droppedFrames() const { return m_droppedFrames.loadRelaxed(); }
+
+    // One line per metric with this machine's details, so files from
+    // different hardware can be put side by side
+    bool writeCsv(const QString &path) const;
+
+    static const char *metricName(Metric metric);
+
+private:
+    TimingHistogram m_histograms[MetricCount];
+    QAtomicInteger<quint64> m_droppedFrames;
+};
+
+// Times its own lifetime into 'histogram', if there is one
+class ProfileScope
+{
+public:
+    explicit ProfileScope(TimingHistogram *histogram)
+        : m_histogram(histogram)
+    {
+        if (m_histogram) m_timer.start();
+    }
+
+    ~ProfileScope()
+    {
+        if (m_histogram) m_histogram->record(m_timer.nsecsElapsed());
+    }
+
+private:
+    TimingHistogram *m_histogram;
+    QElapsedTimer m_timer;
+};
+
+#endif // PROFILER_H
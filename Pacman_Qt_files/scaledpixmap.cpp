@@ -0,0 +1,19 @@
+#include "scaledpixmap.h"
+#include <QPixmapCache>
+#include <QtMath>
+
+QPixmap scaledPixmap(const QPixmap &source, QSize size, qreal dpr, Qt::TransformationMode mode)
+{
+    if (source.isNull()) return source;
+
+    const QSize device(qRound(size.width() * dpr), qRound(size.height() * dpr));
+    const QString key = QString("scaled:%1:%2x%3:%4:%5").arg(source.cacheKey()).arg(device.width())
+                            .arg(device.height()).arg(dpr).arg(int(mode));
+    QPixmap scaled;
+    if (!QPixmapCache::find(key, &scaled)) {
+        scaled = source.scaled(device, Qt::IgnoreAspectRatio, mode);
+        scaled.setDevicePixelRatio(dpr);
+        QPixmapCache::insert(key, scaled);
+    }
+    return scaled;
+}
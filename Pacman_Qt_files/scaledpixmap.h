@@ -0,0 +1,18 @@
+#ifndef SCALEDPIXMAP_H
+#define SCALEDPIXMAP_H
+
+#include <QPixmap>
+#include <QSize>
+
+// Memory for pre-scaled sprites and screens, in KB. Room for every screen
+// in both modes at 2x, plus the tiles for a few zoom steps.
+#define SCALED_PIXMAP_BUDGET_KB (96 * 1024)
+
+// 'source' resampled to 'size' logical pixels at 'dpr' device pixels each,
+// with its pixel ratio set to match, so painting it at that size is a
+// plain copy. Each source, size, ratio and mode is resampled only once
+// and then served from QPixmapCache, which drops the least recently used
+// pixmaps beyond its limit (see SCALED_PIXMAP_BUDGET_KB). GUI thread only.
+QPixmap scaledPixmap(const QPixmap &source, QSize size, qreal dpr, Qt::TransformationMode mode);
+
+#endif // SCALEDPIXMAP_H
@@ -0,0 +1,248 @@
+#include "sessionlog.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+// Record tags: the high nibble is the record type. Input records keep the
+// direction in bits 0-1 and the source in bits 2-3.
+#define TAG_INPUT    0x00
+#define TAG_KEYFRAME 0x10
+#define TAG_END      0x20
+#define TAG_TYPE_MASK 0xF0
+
+static void appendVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+static bool readVarint(const QByteArray &in, int &pos, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        quint8 byte = quint8(in[pos++]);
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// === RECORDER ===
+
+SessionRecorder::SessionRecorder()
+    : m_lastTick(0)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool SessionRecorder::begin(const QString &path, const GameCore &core)
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Could not create session log:" << path;
+        return false;
+    }
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(SESSION_LOG_MAGIC) << quint16(SESSION_LOG_VERSION) << core.seed()
+        << qint32(core.round()) << core.mazeFile() << QDateTime::currentMSecsSinceEpoch();
+    m_file.write(header);
+
+    m_lastTick = core.tick();
+    return true;
+}
+
+void SessionRecorder::recordTick(const GameCore &core, Direction input, InputSource source)
+{
+    if (!m_file.isOpen()) return;
+
+    quint64 tick = core.tick();
+    if (tick % SESSION_KEYFRAME_INTERVAL == 0) {
+        writeRecord(TAG_KEYFRAME, tick, qCompress(core.saveState()));
+        m_file.flush(); // Never lose more than one keyframe interval
+    }
+
+    if (input != Stop) {
+        writeRecord(TAG_INPUT | quint8(input) | (quint8(source) << 2), tick);
+    }
+}
+
+void SessionRecorder::finish(const GameCore &core)
+{
+    if (!m_file.isOpen()) return;
+
+    QByteArray payload;
+    appendVarint(payload, quint64(core.status()));
+    appendVarint(payload, quint64(core.score()));
+    writeRecord(TAG_END, core.tick(), payload);
+    m_file.close();
+}
+
+void SessionRecorder::writeRecord(quint8 tag, quint64 tick, const QByteArray &payload)
+{
+    QByteArray record;
+    record.append(char(tag));
+    appendVarint(record, tick - m_lastTick);
+    if (tag == TAG_KEYFRAME) {
+        appendVarint(record, quint64(payload.size()));
+    }
+    record.append(payload);
+    m_file.write(record);
+    m_lastTick = tick;
+}
+
+// === REPLAYER ===
+
+SessionReplayer::SessionReplayer()
+    : m_seed(0),
+    m_round(1),
+    m_startedMs(0),
+    m_nextEvent(0),
+    m_endTick(0),
+    m_hasEnd(false),
+    m_endStatus(GameCore::Running),
+    m_endScore(0)
+{
+}
+
+bool SessionReplayer::open(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open session log:" << path;
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic;
+    quint16 version;
+    qint32 round;
+    in >> magic >> version;
+    if (magic != SESSION_LOG_MAGIC || version != SESSION_LOG_VERSION) {
+        qDebug() << "Not a session log (or unsupported version):" << path;
+        return false;
+    }
+    in >> m_seed >> round >> m_mazeFile >> m_startedMs;
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Session log header is truncated:" << path;
+        return false;
+    }
+    m_round = round;
+
+    m_events.clear();
+    m_keyframes.clear();
+    m_hasEnd = false;
+    m_endTick = 0;
+
+    // The header is followed by raw records
+    int pos = int(in.device()->pos());
+    quint64 tick = 0;
+    while (pos < data.size()) {
+        quint8 tag = quint8(data[pos++]);
+        quint64 delta;
+        if (!readVarint(data, pos, delta)) break;
+        tick += delta;
+
+        if ((tag & TAG_TYPE_MASK) == TAG_INPUT) {
+            m_events.append({ tick, InputSource((tag >> 2) & 0x3), Direction(tag & 0x3) });
+        } else if ((tag & TAG_TYPE_MASK) == TAG_KEYFRAME) {
+            quint64 length;
+            if (!readVarint(data, pos, length) || pos + qint64(length) > data.size()) break;
+            m_keyframes.append({ tick, data.mid(pos, int(length)) });
+            pos += int(length);
+        } else if ((tag & TAG_TYPE_MASK) == TAG_END) {
+            quint64 status, score;
+            if (!readVarint(data, pos, status) || !readVarint(data, pos, score)) break;
+            m_hasEnd = true;
+            m_endStatus = GameCore::Status(status);
+            m_endScore = int(score);
+        } else {
+            qDebug() << "Unknown record in session log, stopping at tick" << tick;
+            break;
+        }
+        m_endTick = tick;
+    }
+
+    // A log cut short (crash, power loss) still replays up to its last record
+    if (m_keyframes.isEmpty() || m_keyframes[0].tick != 0) {
+        qDebug() << "Session log has no starting keyframe:" << path;
+        return false;
+    }
+    m_nextEvent = 0;
+    return true;
+}
+
+bool SessionReplayer::start(GameCore &core)
+{
+    if (core.mazeFile() != m_mazeFile && !core.loadMaze(m_mazeFile)) {
+        return false;
+    }
+    return seek(core, 0);
+}
+
+bool SessionReplayer::seek(GameCore &core, quint64 tick)
+{
+    if (m_keyframes.isEmpty()) return false;
+    tick = qMin(tick, m_endTick);
+
+    // Last keyframe at or before 'tick'
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), tick,
+                               [](quint64 t, const Keyframe &k) { return t < k.tick; });
+    const Keyframe &keyframe = *(it - 1);
+    if (!core.restoreState(qUncompress(keyframe.state))) {
+        return false;
+    }
+
+    m_nextEvent = int(std::lower_bound(m_events.begin(), m_events.end(), keyframe.tick,
+                                       [](const InputEvent &e, quint64 t) { return e.tick < t; })
+                      - m_events.begin());
+
+    while (core.tick() < tick && core.status() == GameCore::Running) {
+        core.step(inputAt(core.tick()));
+    }
+    return true;
+}
+
+int SessionReplayer::step(GameCore &core)
+{
+    if (core.tick() >= m_endTick || core.status() != GameCore::Running) {
+        return -1;
+    }
+    return core.step(inputAt(core.tick()));
+}
+
+Direction SessionReplayer::inputAt(quint64 tick)
+{
+    // Events are sorted by tick and the replay only moves forward between
+    // seeks, so a cursor is enough
+    while (m_nextEvent < m_events.size() && m_events[m_nextEvent].tick < tick) {
+        m_nextEvent++;
+    }
+    Direction input = Stop;
+    while (m_nextEvent < m_events.size() && m_events[m_nextEvent].tick == tick) {
+        input = m_events[m_nextEvent].direction; // The latest command of a tick wins
+        m_nextEvent++;
+    }
+    return input;
+}
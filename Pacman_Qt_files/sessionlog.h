@@ -0,0 +1,105 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "gamecore.h"
+
+// Binary log of one game: header (seed, round, maze), then a stream of
+// input events and periodic compressed keyframes of the GameCore state.
+//
+// Records are a tag byte followed by varints, so a typical input event is
+// two bytes. Keyframes let a replay seek without simulating from tick 0.
+
+#define SESSION_LOG_MAGIC 0x504D534C // "PMSL"
+#define SESSION_LOG_VERSION 2
+#define SESSION_KEYFRAME_INTERVAL 250 // Ticks between keyframes (10 s of play)
+
+enum InputSource { KeyboardInput, HeadPoseInput, ScriptedInput };
+
+class SessionRecorder
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    // Starts a new log for a round that core.startRound() has just set up
+    bool begin(const QString &path, const GameCore &core);
+
+    // Call once per tick, before core.step(input)
+    void recordTick(const GameCore &core, Direction input, InputSource source);
+
+    // Writes the final status and closes the file
+    void finish(const GameCore &core);
+
+    bool isRecording() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+
+private:
+    void writeRecord(quint8 tag, quint64 tick, const QByteArray &payload = QByteArray());
+
+    QFile m_file;
+    quint64 m_lastTick;
+};
+
+class SessionReplayer
+{
+public:
+    struct InputEvent {
+        quint64 tick;
+        InputSource source;
+        Direction direction;
+    };
+
+    struct Keyframe {
+        quint64 tick;
+        QByteArray state; // qCompress()ed GameCore::saveState()
+    };
+
+    SessionReplayer();
+
+    bool open(const QString &path);
+
+    // Loads the recorded maze into 'core' and puts it at tick 0
+    bool start(GameCore &core);
+
+    // Restores the nearest keyframe at or before 'tick' and simulates the
+    // remaining ticks, leaving core.tick() == tick (or the end of the log)
+    bool seek(GameCore &core, quint64 tick);
+
+    // Steps 'core' by one tick with the recorded input. Returns the step()
+    // event flags, or -1 once the end of the recording has been reached.
+    int step(GameCore &core);
+
+    Direction inputAt(quint64 tick);
+
+    quint64 seed() const { return m_seed; }
+    int round() const { return m_round; }
+    QString mazeFile() const { return m_mazeFile; }
+    qint64 startedMs() const { return m_startedMs; }
+    quint64 endTick() const { return m_endTick; }
+    bool hasEnd() const { return m_hasEnd; }
+    GameCore::Status endStatus() const { return m_endStatus; }
+    int endScore() const { return m_endScore; }
+    const QVector<InputEvent> &events() const { return m_events; }
+    int keyframeCount() const { return m_keyframes.size(); }
+
+private:
+    quint64 m_seed;
+    int m_round;
+    QString m_mazeFile;
+    qint64 m_startedMs;
+    QVector<InputEvent> m_events;
+    QVector<Keyframe> m_keyframes;
+    int m_nextEvent;
+
+    quint64 m_endTick;
+    bool m_hasEnd;
+    GameCore::Status m_endStatus;
+    int m_endScore;
+};
+
+#endif // SESSIONLOG_H
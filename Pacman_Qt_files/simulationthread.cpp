@@ -0,0 +1,287 @@
+#include "simulationthread.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QMutexLocker>
+#include <chrono>
+
+SimulationThread::SimulationThread(QObject *parent)
+    : QThread(parent),
+    m_commandsQueued(0),
+    m_commandsDone(0),
+    m_quit(false),
+    m_input(0),
+    m_running(false),
+    m_replaying(false),
+    m_replayEnded(false),
+    m_simTimeNs(0),
+    m_unreadEvents(0),
+    m_prevGhostEnd(0)
+{
+    m_clock.start();
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+// === CONTROL (GUI thread) ===
+
+bool SimulationThread::loadMaze(const QString &path)
+{
+    bool ok = false;
+    invoke([&]() {
+        ok = m_core.loadMaze(path);
+        if (ok) {
+            qDebug() << "Maze" << path << "is" << m_core.mazeWidth() << "x" << m_core.mazeHeight()
+                     << (m_core.usesClusterPaths() ? "(cluster paths)" : "(path table)");
+        }
+        m_running = false;
+        publish(false, 0);
+    });
+    return ok;
+}
+
+bool SimulationThread::startRound(int round, bool resetScore, quint64 seed, const QString &recordPath)
+{
+    bool ok = false;
+    invoke([&]() {
+        if (!m_core.hasStartPosition()) {
+            qDebug() << "Start position 'p' not found!";
+            return;
+        }
+
+        // Close the previous log before the core moves on to the new round
+        finishRecording();
+        qDebug() << "Starting round" << round << "with seed" << seed;
+        m_core.startRound(round, resetScore, seed);
+        if (m_recorder.begin(recordPath, m_core)) {
+            qDebug() << "Recording session to" << m_recorder.path();
+        }
+
+        m_input.storeRelease(0);
+        m_unreadEvents = 0;
+        m_replaying = false;
+        m_replayEnded = false;
+        m_running = true;
+        m_simTimeNs = m_clock.nsecsElapsed();
+        publish(false, 0);
+        ok = true;
+    });
+    return ok;
+}
+
+bool SimulationThread::startReplay(const QString &path, int *round)
+{
+    bool ok = false;
+    invoke([&]() {
+        finishRecording();
+        if (!m_replayer.open(path) || !m_replayer.start(m_core)) {
+            return;
+        }
+
+        *round = m_replayer.round();
+        m_unreadEvents = 0;
+        m_replaying = true;
+        m_replayEnded = false;
+        m_running = true;
+        m_simTimeNs = m_clock.nsecsElapsed();
+        publish(false, 0);
+        ok = true;
+    });
+    return ok;
+}
+
+void SimulationThread::seekReplay(qint64 ticks)
+{
+    invoke([&]() {
+        if (!m_replaying) return;
+
+        qint64 target = qint64(m_core.tick()) + ticks;
+        m_replayer.seek(m_core, quint64(qMax<qint64>(0, target)));
+        m_replayEnded = false;
+        m_running = true;
+        m_simTimeNs = m_clock.nsecsElapsed();
+        publish(false, 0);
+    });
+}
+
+void SimulationThread::pause()
+{
+    invoke([&]() {
+        m_running = false;
+        publish(false, 0);
+    });
+}
+
+void SimulationThread::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_wake.wakeOne();
+    }
+    wait();
+
+    // The thread is gone, so the recorder is ours now
+    finishRecording();
+}
+
+void SimulationThread::setProfiler(Profiler *profiler)
+{
+    invoke([&]() {
+        m_core.setProfiler(profiler);
+    });
+}
+
+void SimulationThread::setInput(Direction dir, InputSource source)
+{
+    m_input.storeRelease((int(source) << 8) | (int(dir) + 1));
+}
+
+// Queues a command for the simulation thread and waits until it has run
+void SimulationThread::invoke(const std::function<void()> &command)
+{
+    QMutexLocker locker(&m_mutex);
+    m_commands.append(command);
+    const quint64 ticket = ++m_commandsQueued;
+    m_wake.wakeOne();
+    while (m_commandsDone < ticket) {
+        m_commandDone.wait(&m_mutex);
+    }
+}
+
+// === SIMULATION THREAD ===
+
+void SimulationThread::run()
+{
+    const qint64 tickNs = qint64(FRAMETIME) * 1000000;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_quit) {
+        // Commands go first, so a control request never queues behind ticks
+        if (!m_commands.isEmpty()) {
+            std::function<void()> command = m_commands.takeFirst();
+            locker.unlock();
+            command();
+            locker.relock();
+            m_commandsDone++;
+            m_commandDone.wakeAll();
+            continue;
+        }
+
+        if (!m_running) {
+            m_wake.wait(&m_mutex);
+            continue;
+        }
+
+        const qint64 now = m_clock.nsecsElapsed();
+        const qint64 untilNextTick = m_simTimeNs + tickNs - now;
+        if (untilNextTick > 0) {
+            m_wake.wait(&m_mutex, QDeadlineTimer(std::chrono::nanoseconds(untilNextTick), Qt::PreciseTimer));
+            continue;
+        }
+
+        locker.unlock();
+        runDueTicks(now);
+        locker.relock();
+    }
+}
+
+void SimulationThread::runDueTicks(qint64 now)
+{
+    // Tick for every whole FRAMETIME the clock is ahead. m_simTimeNs moves
+    // in exact FRAMETIME steps, so wake-up jitter can't drift the game speed.
+    const qint64 tickNs = qint64(FRAMETIME) * 1000000;
+    int ticks = 0;
+    while (m_running && now - m_simTimeNs >= tickNs) {
+        if (ticks == MAX_CATCHUP_TICKS) {
+            m_simTimeNs += (now - m_simTimeNs) / tickNs * tickNs;
+            break;
+        }
+        m_simTimeNs += tickNs;
+        runTick();
+        ticks++;
+    }
+}
+
+void SimulationThread::runTick()
+{
+    const GhostPool &ghosts = m_core.ghostPool();
+    m_prevPacmanCenter = m_core.pacmanCenter();
+    m_prevGhostCenters = ghosts.center;
+    m_prevGhostEnd = ghosts.end();
+
+    // Pac-Man, ghosts and collisions all run inside GameCore::step()
+    int events;
+    if (m_replaying) {
+        events = m_replayer.step(m_core);
+        if (events < 0) {
+            // End of the recording: hold the last frame
+            m_running = false;
+            m_replayEnded = true;
+            events = 0;
+        }
+    } else {
+        int input = m_input.fetchAndStoreAcquire(0);
+        Direction dir = input ? Direction((input & 0xFF) - 1) : Stop;
+        InputSource source = InputSource(input >> 8);
+        m_recorder.recordTick(m_core, dir, source);
+        events = m_core.step(dir);
+    }
+
+    if (m_core.status() != GameCore::Running) {
+        m_running = false;
+        finishRecording();
+    }
+    publish(true, events);
+}
+
+// Fills the back snapshot from the game and hands it to the reader. After
+// anything but a tick, pieces are shown where they are, not interpolated.
+void SimulationThread::publish(bool stepped, int events)
+{
+    GameSnapshot &snapshot = m_snapshots.back();
+    snapshot.tick = m_core.tick();
+    snapshot.simTimeNs = m_simTimeNs;
+    snapshot.events = events | m_unreadEvents;
+    snapshot.status = m_core.status();
+    snapshot.running = m_running;
+    snapshot.replaying = m_replaying;
+    snapshot.replayEnded = m_replayEnded;
+    snapshot.round = m_core.round();
+    snapshot.score = m_core.score();
+    snapshot.pelletsLeft = m_core.pelletsLeft() + m_core.powerPelletsLeft();
+    snapshot.maze = m_core.maze();
+
+    snapshot.pacmanCenter = m_core.pacmanCenter();
+    snapshot.pacmanPrevious = stepped ? m_prevPacmanCenter : snapshot.pacmanCenter;
+    snapshot.pacmanDirection = m_core.pacmanDirection();
+    snapshot.pacmanMouthAngle = m_core.pacmanMouthAngle();
+    snapshot.pacmanMoving = m_core.isPacmanMoving();
+
+    const GhostPool &ghosts = m_core.ghostPool();
+    snapshot.ghosts.clear();
+    for (int slot = 0; slot < ghosts.end(); ++slot) {
+        if (!(ghosts.state[slot] & GhostPool::Active)) continue;
+        GhostSprite sprite;
+        sprite.center = ghosts.center[slot];
+        sprite.previous = (stepped && slot < m_prevGhostEnd) ? m_prevGhostCenters[slot] : sprite.center;
+        sprite.type = ghosts.traits[slot].type;
+        sprite.mode = GhostMode(ghosts.mode[slot]);
+        sprite.direction = ghosts.traits[slot].direction;
+        sprite.color = ghosts.traits[slot].color;
+        snapshot.ghosts.append(sprite);
+    }
+
+    // A snapshot the reader never saw comes back as the next back buffer;
+    // keep its events so no sound or game-over is lost
+    m_unreadEvents = m_snapshots.publish() ? m_snapshots.back().events : 0;
+}
+
+void SimulationThread::finishRecording()
+{
+    if (m_recorder.isRecording()) {
+        m_recorder.finish(m_core);
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+
+#include "gamecore.h"
+#include "sessionlog.h"
+#include "triplebuffer.h"
+
+// Most ticks simulated in one go to catch up after a stall. Time beyond
+// that is dropped, so a long hitch pauses the game instead of fast-forwarding.
+#define MAX_CATCHUP_TICKS 5
+
+// What a ghost looks like in one snapshot
+struct GhostSprite {
+    QPoint center;
+    QPoint previous;          // Center one tick earlier, for interpolation
+    GhostType type;
+    GhostMode mode;
+    Direction direction;
+    Color color;
+};
+
+// Everything the widget draws, as of one tick. Never changed once published.
+struct GameSnapshot {
+    quint64 tick = 0;
+    qint64 simTimeNs = 0;     // Clock time this tick stands for
+    int events = 0;           // GameCore::Event flags since the last snapshot fetched
+    GameCore::Status status = GameCore::Running;
+    bool running = false;     // Ticking, as opposed to paused, over or not started
+    bool replaying = false;
+    bool replayEnded = false;
+    int round = 1;
+    int score = 0;
+    int pelletsLeft = 0;      // Regular and power pellets
+    MazeBits maze;            // Implicitly shared with the game until a pellet goes
+
+    QPoint pacmanCenter;
+    QPoint pacmanPrevious;    // One tick earlier, for interpolation
+    Direction pacmanDirection = Right;
+    int pacmanMouthAngle = 0;
+    bool pacmanMoving = false;
+
+    QVector<GhostSprite> ghosts; // Active ghosts, in pool slot order
+};
+
+// Runs the GameCore on its own thread at a fixed FRAMETIME tick.
+//
+// The game, the session recorder and the replayer live on this thread
+// only. The GUI thread controls it through the blocking calls below, hands
+// over input through an atomic, and reads the game through immutable
+// snapshots published every tick into a TripleBuffer, so neither side ever
+// waits for the other during play.
+class SimulationThread : public QThread
+{
+public:
+    explicit SimulationThread(QObject *parent = nullptr);
+    ~SimulationThread() override;
+
+    // Control, from the GUI thread. Each returns once the simulation thread
+    // has carried it out; none of them runs while a tick is in progress.
+    bool loadMaze(const QString &path);
+    bool startRound(int round, bool resetScore, quint64 seed, const QString &recordPath);
+    bool startReplay(const QString &path, int *round);
+    void seekReplay(qint64 ticks); // Relative to the current tick
+    void pause();
+
+    // Ends the simulation thread and closes any recording; the destructor
+    // does this too. No other control call may follow it.
+    void stop();
+
+    // Times the game's ticks into 'profiler' from now on (see GameCore)
+    void setProfiler(Profiler *profiler);
+
+    // Direction requested since the last tick, applied on the next one.
+    // Lock-free, so head pose commands are never held up by a paint.
+    void setInput(Direction dir, InputSource source);
+
+    // Reader side, GUI thread only. fetchSnapshot() is false if nothing
+    // newer was published since the last call.
+    bool fetchSnapshot() { return m_snapshots.fetch(); }
+    const GameSnapshot &snapshot() const { return m_snapshots.front(); }
+    qint64 clockNs() const { return m_clock.nsecsElapsed(); }
+
+protected:
+    void run() override;
+
+private:
+    void invoke(const std::function<void()> &command);
+    void runDueTicks(qint64 now);
+    void runTick();
+    void publish(bool stepped, int events);
+    void finishRecording();
+
+    QMutex m_mutex;                          // Guards the command queue and m_quit
+    QWaitCondition m_wake;                   // Simulation thread: command, quit or tick due
+    QWaitCondition m_commandDone;            // Callers of invoke(): a command finished
+    QVector<std::function<void()>> m_commands;
+    quint64 m_commandsQueued;
+    quint64 m_commandsDone;
+    bool m_quit;
+
+    QAtomicInt m_input;                      // (source << 8) | (direction + 1), 0 for none
+    QElapsedTimer m_clock;
+
+    // Simulation thread only
+    GameCore m_core;
+    SessionRecorder m_recorder;
+    SessionReplayer m_replayer;
+    bool m_running;
+    bool m_replaying;
+    bool m_replayEnded;
+    qint64 m_simTimeNs;                      // Clock time the simulation has caught up to
+    int m_unreadEvents;                      // Events of a snapshot the reader skipped
+    QPoint m_prevPacmanCenter;
+    QVector<QPoint> m_prevGhostCenters;      // Per ghost pool slot
+    int m_prevGhostEnd;
+
+    TripleBuffer<GameSnapshot> m_snapshots;
+};
+
+#endif // SIMULATIONTHREAD_H
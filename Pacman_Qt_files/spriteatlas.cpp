@@ -0,0 +1,253 @@
+#include "spriteatlas.h"
+#include "gamecore.h"
+#include <QPainterPath>
+#include <QtMath>
+
+// Atlas layout: a row per Pac-Man colour, then a ghost row per type and a
+// shared one for panic. Pac-Man cells go by direction, then mouth frame;
+// ghost cells by direction (Stop included).
+#define ATLAS_COLUMNS   (4 * PACMAN_MOUTH_FRAMES)
+#define GHOST_PANIC_ROW (IntersectionRandom + 1)
+
+SpriteAtlas::SpriteAtlas()
+    : m_pixelated(false),
+    m_scale(1.0),
+    m_cellSize(TILE_SIZE),
+    m_dirty(true)
+{
+}
+
+void SpriteAtlas::setPacmanColors(const QVector<QColor> &colors)
+{
+    m_pacmanColors = colors;
+    m_dirty = true;
+}
+
+void SpriteAtlas::setPixelated(bool pixelated)
+{
+    if (pixelated == m_pixelated) return;
+    m_pixelated = pixelated;
+    m_dirty = true;
+}
+
+void SpriteAtlas::setScale(qreal scale)
+{
+    if (qFuzzyCompare(scale, m_scale)) return;
+    m_scale = scale;
+    m_dirty = true;
+}
+
+void SpriteAtlas::drawPacman(QPainter &painter, QPoint center, int colorIndex, Direction dir, int mouthAngle) const
+{
+    blit(painter, center, pacmanCell(colorIndex, dir, mouthAngle));
+}
+
+void SpriteAtlas::drawGhost(QPainter &painter, QPoint center, GhostType type, GhostMode mode, Direction dir) const
+{
+    blit(painter, center, ghostCell(type, mode, dir));
+}
+
+QRect SpriteAtlas::pacmanCell(int colorIndex, Direction dir, int mouthAngle) const
+{
+    const int frame = qBound(0, (mouthAngle - PACMAN_MOUTH_MIN + PACMAN_MOUTH_STEP / 2) / PACMAN_MOUTH_STEP,
+                             PACMAN_MOUTH_FRAMES - 1);
+    const int direction = (dir == Stop) ? Right : dir;
+    return cell(direction * PACMAN_MOUTH_FRAMES + frame, colorIndex);
+}
+
+QRect SpriteAtlas::ghostCell(GhostType type, GhostMode mode, Direction dir) const
+{
+    const int ghostRow = (mode == Panic) ? GHOST_PANIC_ROW : type;
+    return cell(dir, m_pacmanColors.size() + ghostRow);
+}
+
+void SpriteAtlas::blit(QPainter &painter, QPoint center, const QRect &cell) const
+{
+    painter.drawImage(QRect(center.x() - TILE_SIZE / 2, center.y() - TILE_SIZE / 2, TILE_SIZE, TILE_SIZE), m_atlas, cell);
+}
+
+void SpriteAtlas::build()
+{
+    m_dirty = false;
+    m_cellSize = qCeil(TILE_SIZE * m_scale);
+    const int rows = m_pacmanColors.size() + GHOST_PANIC_ROW + 1;
+    m_atlas = QImage(ATLAS_COLUMNS * m_cellSize, rows * m_cellSize, QImage::Format_ARGB32_Premultiplied);
+    m_atlas.fill(Qt::transparent);
+
+    QPainter painter(&m_atlas);
+    painter.setRenderHint(QPainter::Antialiasing, !m_pixelated);
+    auto enterCell = [&](int col, int row) {
+        painter.save();
+        painter.translate(col * m_cellSize, row * m_cellSize);
+        painter.scale(qreal(m_cellSize) / TILE_SIZE, qreal(m_cellSize) / TILE_SIZE);
+    };
+
+    for (int row = 0; row < m_pacmanColors.size(); ++row) {
+        for (int dir = Up; dir <= Right; ++dir) {
+            for (int frame = 0; frame < PACMAN_MOUTH_FRAMES; ++frame) {
+                enterCell(dir * PACMAN_MOUTH_FRAMES + frame, row);
+                renderPacman(painter, m_pacmanColors[row], Direction(dir),
+                             PACMAN_MOUTH_MIN + frame * PACMAN_MOUTH_STEP);
+                painter.restore();
+            }
+        }
+    }
+
+    const int firstGhostRow = m_pacmanColors.size();
+    for (int type = Original; type <= GHOST_PANIC_ROW; ++type) {
+        const bool panic = (type == GHOST_PANIC_ROW);
+        Ghost ghost;
+        ghost.type = panic ? Original : GhostType(type);
+        const Color color = GameCore::getGhostColor(ghost);
+        for (int dir = Up; dir <= Stop; ++dir) {
+            enterCell(dir, firstGhostRow + type);
+            renderGhost(painter, panic ? QColor(0, 100, 255) : QColor(color.r, color.g, color.b), panic,
+                        Direction(dir));
+            painter.restore();
+        }
+    }
+}
+
+// Draws one Pac-Man frame into the TILE_SIZE square at the painter's origin.
+// Pixel mode draws at quarter resolution and scales up for the blocky look.
+void SpriteAtlas::renderPacman(QPainter &painter, const QColor &color, Direction dir, int mouthAngle)
+{
+    const int resolution = m_pixelated ? TILE_SIZE / 4 : TILE_SIZE;
+    QPixmap buffer;
+    QPainter bufferPainter;
+    QPainter *target = &painter;
+    if (m_pixelated) {
+        buffer = QPixmap(resolution, resolution);
+        buffer.fill(Qt::transparent);
+        bufferPainter.begin(&buffer);
+        bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+        target = &bufferPainter;
+    }
+
+    target->setPen(Qt::NoPen);
+    target->setBrush(color);
+
+    int angle = mouthAngle * 16;
+    int span = (360 - mouthAngle * 2) * 16;
+    int startAngle = 0;
+
+    // Rotate the mouth based on direction
+    switch (dir) {
+    case Right: startAngle = angle / 2; break;
+    case Left:  startAngle = (180 * 16) + (angle / 2); break;
+    case Up:    startAngle = (90 * 16) + (angle / 2); break;
+    case Down:  startAngle = (270 * 16) + (angle / 2); break;
+    default:    startAngle = angle / 2; break;
+    }
+    target->drawPie(QRect(0, 0, resolution, resolution), startAngle, span);
+
+    if (m_pixelated) {
+        bufferPainter.end();
+        painter.drawPixmap(QRect(0, 0, TILE_SIZE, TILE_SIZE), buffer);
+    }
+}
+
+// Draws one ghost frame into the TILE_SIZE square at the painter's origin
+void SpriteAtlas::renderGhost(QPainter &painter, const QColor &color, bool panic, Direction dir)
+{
+    if (m_pixelated) {
+        // An 8x8 buffer scaled up to TILE_SIZE, for a blocky, low-resolution look
+        const int bufferResolution = TILE_SIZE / 4;
+        QPixmap buffer(bufferResolution, bufferResolution);
+        buffer.fill(Qt::transparent);
+        QPainter drawTarget(&buffer);
+        drawTarget.setRenderHint(QPainter::Antialiasing, false);
+
+        // Body - colored circle
+        drawTarget.setBrush(color);
+        drawTarget.setPen(Qt::NoPen);
+        drawTarget.drawEllipse(buffer.rect());
+
+        // Eyes - simple white dots
+        drawTarget.setBrush(Qt::white);
+        int eyeR = bufferResolution / 6;
+        QPoint leftEye(bufferResolution / 3, bufferResolution / 3);
+        QPoint rightEye(2 * bufferResolution / 3, bufferResolution / 3);
+        drawTarget.drawEllipse(leftEye, eyeR, eyeR);
+        drawTarget.drawEllipse(rightEye, eyeR, eyeR);
+
+        // Pupils - centered black dots
+        drawTarget.setBrush(Qt::black);
+        int pupilR = bufferResolution / 12;
+        drawTarget.drawEllipse(leftEye, pupilR, pupilR);
+        drawTarget.drawEllipse(rightEye, pupilR, pupilR);
+        drawTarget.end();
+
+        painter.drawPixmap(QRect(0, 0, TILE_SIZE, TILE_SIZE), buffer);
+        return;
+    }
+
+    const QPoint center(TILE_SIZE / 2, TILE_SIZE / 2);
+    const int r = TILE_SIZE / 2;
+    painter.setBrush(color);
+    painter.setPen(Qt::NoPen);
+
+    // Use a QPainterPath to create the ghost shape
+    QPainterPath path;
+
+    // Top semi-circle
+    QRectF head(center.x() - r, center.y() - r, TILE_SIZE, TILE_SIZE);
+    path.arcMoveTo(head, 180);
+    path.arcTo(head, 180, -180); // Arc from left to right over the top
+
+    // Wavy bottom
+    int numWaves = 3;
+    float waveWidth = (float)TILE_SIZE / numWaves;
+    float waveHeight = TILE_SIZE / 6;
+
+    QPointF current = path.currentPosition(); // Should be (center.x + r, center.y)
+
+    for (int i = 0; i < numWaves; ++i) {
+        QPointF p1 = QPointF(current.x() - (waveWidth / 2.0), current.y() + waveHeight);
+        QPointF p2 = QPointF(current.x() - waveWidth, current.y());
+        path.quadTo(p1, p2);
+        current = p2;
+    }
+
+    path.closeSubpath(); // Connects back to (center.x - r, center.y)
+    painter.drawPath(path);
+
+    // --- Draw Eyes ---
+    painter.setBrush(Qt::white);
+    int eyeR = TILE_SIZE / 6;
+    QPoint leftEyeCenter(center.x() - TILE_SIZE/4, center.y() - TILE_SIZE/6);
+    QPoint rightEyeCenter(center.x() + TILE_SIZE/4, center.y() - TILE_SIZE/6);
+
+    painter.drawEllipse(leftEyeCenter, eyeR, eyeR);
+    painter.drawEllipse(rightEyeCenter, eyeR, eyeR);
+
+    if (panic)
+    {
+        // Simple scared mouth
+        painter.setPen(QPen(Qt::white, 2));
+        painter.setBrush(Qt::NoBrush);
+        QPainterPath mouth;
+        mouth.moveTo(center.x() - TILE_SIZE/4, center.y() + TILE_SIZE/4);
+        mouth.quadTo(center.x(), center.y() + TILE_SIZE/8,
+                     center.x() + TILE_SIZE/4, center.y() + TILE_SIZE/4);
+        painter.drawPath(mouth);
+    }
+    else
+    {
+        // Pupils looking in the direction of movement
+        painter.setBrush(Qt::black);
+        int pupilR = TILE_SIZE / 12;
+        QPoint pupilOffset(0,0);
+
+        switch(dir) {
+        case Left: pupilOffset.setX(-eyeR/2); break;
+        case Right: pupilOffset.setX(eyeR/2); break;
+        case Up: pupilOffset.setY(-eyeR/2); break;
+        case Down: pupilOffset.setY(eyeR/2); break;
+        default: break;
+        }
+
+        painter.drawEllipse(leftEyeCenter + pupilOffset, pupilR, pupilR);
+        painter.drawEllipse(rightEyeCenter + pupilOffset, pupilR, pupilR);
+    }
+}
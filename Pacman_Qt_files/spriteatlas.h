@@ -0,0 +1,63 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <QVector>
+
+#include "gametypes.h"
+
+// Pac-Man's mouth runs through these angles (see GameCore::step())
+#define PACMAN_MOUTH_MIN    -5
+#define PACMAN_MOUTH_STEP   15
+#define PACMAN_MOUTH_FRAMES 5
+
+// Every Pac-Man and ghost frame, pre-rendered into one image.
+//
+// Pac-Man has a cell per colour, direction and mouth frame; a ghost one per
+// type (or panic) and direction. The atlas is rebuilt only when the colours,
+// the mode or the scale change, so drawing an actor is one sub-rect blit
+// with no allocation and no path building. Once prepare()d, drawing may
+// run on several threads at once.
+class SpriteAtlas
+{
+public:
+    SpriteAtlas();
+
+    void setPacmanColors(const QVector<QColor> &colors);
+    void setPixelated(bool pixelated);
+
+    // Device pixels per maze pixel (zoom times the screen's pixel ratio)
+    void setScale(qreal scale);
+
+    // Rebuilds the atlas if anything above changed; call before drawing
+    void prepare() { if (m_dirty) build(); }
+
+    void drawPacman(QPainter &painter, QPoint center, int colorIndex, Direction dir, int mouthAngle) const;
+    void drawGhost(QPainter &painter, QPoint center, GhostType type, GhostMode mode, Direction dir) const;
+
+    // The atlas itself and where each frame sits in it, for drawing
+    // without a QPainter (see PixelFrame)
+    const QImage &image() const { return m_atlas; }
+    QRect pacmanCell(int colorIndex, Direction dir, int mouthAngle) const;
+    QRect ghostCell(GhostType type, GhostMode mode, Direction dir) const;
+
+private:
+    void build();
+    void renderPacman(QPainter &painter, const QColor &color, Direction dir, int mouthAngle);
+    void renderGhost(QPainter &painter, const QColor &color, bool panic, Direction dir);
+    void blit(QPainter &painter, QPoint center, const QRect &cell) const;
+    QRect cell(int col, int row) const { return QRect(col * m_cellSize, row * m_cellSize, m_cellSize, m_cellSize); }
+
+    QVector<QColor> m_pacmanColors;
+    bool m_pixelated;
+    qreal m_scale;
+    int m_cellSize;                   // Device pixels per side of a cell
+    bool m_dirty;
+    QImage m_atlas;
+};
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,99 @@
+#include "tickscheduler.h"
+
+TickScheduler::TickScheduler()
+    : m_freeNodes(-1),
+    m_next(0)
+{
+    clear(0);
+}
+
+void TickScheduler::clear(quint64 tick)
+{
+    // Keep the nodes allocated, just invalidate every handle to them
+    m_freeNodes = -1;
+    for (int node = m_nodes.size() - 1; node >= 0; --node) {
+        if (m_nodes[node].pending) m_nodes[node].generation++;
+        m_nodes[node].pending = false;
+        m_nodes[node].next = m_freeNodes;
+        m_freeNodes = node;
+    }
+    for (int bucket = 0; bucket < TICK_WHEEL_SIZE; ++bucket) {
+        m_head[bucket] = -1;
+        m_tail[bucket] = -1;
+    }
+    m_next = tick;
+}
+
+TimerHandle TickScheduler::schedule(quint64 dueTick, int kind, GhostHandle ghost)
+{
+    int node = m_freeNodes;
+    if (node >= 0) {
+        m_freeNodes = m_nodes[node].next;
+    } else {
+        node = m_nodes.size();
+        m_nodes.append(Node());
+        m_nodes[node].generation = 0;
+    }
+
+    Node &timer = m_nodes[node];
+    timer.due = qMax(dueTick, m_next);
+    timer.kind = kind;
+    timer.ghost = ghost;
+    timer.pending = true;
+    timer.cancelled = false;
+    append(int(timer.due & (TICK_WHEEL_SIZE - 1)), node);
+    return { node, timer.generation };
+}
+
+void TickScheduler::cancel(TimerHandle handle)
+{
+    if (isPending(handle)) {
+        m_nodes[handle.node].cancelled = true;
+    }
+}
+
+bool TickScheduler::isPending(TimerHandle handle) const
+{
+    if (handle.node < 0 || handle.node >= m_nodes.size()) return false;
+    const Node &timer = m_nodes[handle.node];
+    return timer.pending && !timer.cancelled && timer.generation == handle.generation;
+}
+
+int TickScheduler::takeDue(quint64 tick)
+{
+    const int bucket = int(tick & (TICK_WHEEL_SIZE - 1));
+    int node = m_head[bucket];
+    m_head[bucket] = -1;
+    m_tail[bucket] = -1;
+
+    int dueHead = -1, dueTail = -1;
+    while (node >= 0) {
+        const int next = m_nodes[node].next;
+        m_nodes[node].next = -1;
+        if (m_nodes[node].due == tick) {
+            if (dueTail >= 0) m_nodes[dueTail].next = node;
+            else dueHead = node;
+            dueTail = node;
+        } else {
+            append(bucket, node); // A later lap
+        }
+        node = next;
+    }
+    return dueHead;
+}
+
+void TickScheduler::append(int bucket, int node)
+{
+    m_nodes[node].next = -1;
+    if (m_tail[bucket] >= 0) m_nodes[m_tail[bucket]].next = node;
+    else m_head[bucket] = node;
+    m_tail[bucket] = node;
+}
+
+void TickScheduler::release(int node)
+{
+    m_nodes[node].pending = false;
+    m_nodes[node].generation++;
+    m_nodes[node].next = m_freeNodes;
+    m_freeNodes = node;
+}
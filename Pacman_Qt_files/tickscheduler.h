@@ -0,0 +1,82 @@
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+#include "ghostpool.h"
+
+// Refers to a scheduled timer; stale once it fires or is cancelled
+struct TimerHandle {
+    int node = -1;
+    quint32 generation = 0;
+};
+
+// Timed game events on the simulation clock, as a hashed timer wheel.
+//
+// A timer due at tick t waits in bucket t % TICK_WHEEL_SIZE, so scheduling
+// and cancelling are O(1) and advancing one tick only looks at one bucket.
+// Timers more than a lap ahead share the bucket and are skipped until their
+// lap comes round. Nothing here reads the wall clock, so timers behave the
+// same headless, in replays and at any playback speed.
+#define TICK_WHEEL_SIZE 256 // Power of two
+
+class TickScheduler
+{
+public:
+    TickScheduler();
+
+    // Drops every timer; the next advance() handles 'tick'
+    void clear(quint64 tick);
+
+    // Fires 'kind' at 'dueTick' (at least the next unhandled tick), with
+    // an optional ghost it is about
+    TimerHandle schedule(quint64 dueTick, int kind, GhostHandle ghost = GhostHandle());
+    void cancel(TimerHandle handle);
+    bool isPending(TimerHandle handle) const;
+    quint64 dueTick(TimerHandle handle) const { return m_nodes[handle.node].due; }
+
+    // Handles every tick up to and including 'tick', calling
+    // fire(kind, ghost) for each timer due, in the order they were
+    // scheduled. fire() may schedule and cancel timers.
+    template<typename Fire>
+    void advance(quint64 tick, Fire fire)
+    {
+        while (m_next <= tick) {
+            const quint64 now = m_next++;
+            int due = takeDue(now);
+            while (due >= 0) {
+                const int node = due;
+                due = m_nodes[node].next;
+                const Node timer = m_nodes[node];
+                release(node);
+                if (!timer.cancelled) fire(timer.kind, timer.ghost);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        quint64 due;
+        int kind;
+        GhostHandle ghost;
+        int next;              // Next node in the bucket or free list
+        quint32 generation;
+        bool pending;
+        bool cancelled;        // Left in its bucket until the tick comes
+    };
+
+    // Unlinks the timers due at 'tick' from their bucket and returns them
+    // as a list, leaving later laps in place
+    int takeDue(quint64 tick);
+    void append(int bucket, int node);
+    void release(int node);
+
+    QVector<Node> m_nodes;
+    int m_freeNodes;           // Head of the free list, -1 if empty
+    int m_head[TICK_WHEEL_SIZE];
+    int m_tail[TICK_WHEEL_SIZE];
+    quint64 m_next;            // First tick advance() has not handled yet
+};
+
+#endif // TICKSCHEDULER_H
@@ -0,0 +1,39 @@
+#include "tileindex.h"
+
+TileIndex::TileIndex()
+    : m_width(0),
+    m_height(0)
+{
+}
+
+void TileIndex::reset(int width, int height, int capacity)
+{
+    Q_ASSERT(capacity <= 32767);
+    if (width == m_width && height == m_height && !m_head.isEmpty()) {
+        // Same maze: only the occupied tiles need clearing, not all of them
+        for (int slot = 0; slot < m_tileOf.size(); ++slot) {
+            if (m_tileOf[slot] >= 0) m_head[m_tileOf[slot]] = -1;
+        }
+    } else {
+        m_width = width;
+        m_height = height;
+        m_head.fill(-1, width * height);
+    }
+    m_next.fill(-1, capacity);
+    m_tileOf.fill(-1, capacity);
+}
+
+void TileIndex::remove(int slot)
+{
+    const int index = m_tileOf[slot];
+    if (index < 0) return;
+
+    // Lists are a handful of slots long, so a walk beats a back-pointer
+    qint16 *link = &m_head[index];
+    while (*link != slot) {
+        link = &m_next[*link];
+    }
+    *link = m_next[slot];
+    m_next[slot] = -1;
+    m_tileOf[slot] = -1;
+}
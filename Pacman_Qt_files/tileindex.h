@@ -0,0 +1,59 @@
+#ifndef TILEINDEX_H
+#define TILEINDEX_H
+
+#include <QPoint>
+#include <QVector>
+#include <QtGlobal>
+
+// Which pool slots stand on which tile, for contact tests.
+//
+// Every tile heads a short list of slots threaded through a per-slot 'next'
+// array, so moving a slot between tiles is a couple of stores and a query
+// only looks at the tiles around a point instead of at every slot. Tiles
+// take 2 bytes each, so even a 4096x4096 maze stays at 32 MB.
+class TileIndex
+{
+public:
+    TileIndex();
+
+    // Empties the index for a width x height maze and 'capacity' slots
+    void reset(int width, int height, int capacity);
+
+    // Puts a slot on a tile, taking it off its old one first. Cheap when
+    // the tile has not changed, so callers can call it after every step.
+    void place(int slot, QPoint tile)
+    {
+        const int index = tile.y() * m_width + tile.x();
+        if (m_tileOf[slot] == index) return;
+        remove(slot);
+        m_next[slot] = m_head[index];
+        m_head[index] = qint16(slot);
+        m_tileOf[slot] = index;
+    }
+    void remove(int slot);
+
+    // Calls visit(slot) for every slot on 'tile' and the eight tiles around
+    // it, in no particular order
+    template<typename Visit>
+    void forEachNear(QPoint tile, Visit visit) const
+    {
+        const int firstRow = qMax(0, tile.y() - 1), lastRow = qMin(m_height - 1, tile.y() + 1);
+        const int firstCol = qMax(0, tile.x() - 1), lastCol = qMin(m_width - 1, tile.x() + 1);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                for (int slot = m_head[row * m_width + col]; slot >= 0; slot = m_next[slot]) {
+                    visit(slot);
+                }
+            }
+        }
+    }
+
+private:
+    int m_width;
+    int m_height;
+    QVector<qint16> m_head;    // First slot per tile, -1 if empty
+    QVector<qint16> m_next;    // Next slot on the same tile, -1 at the end
+    QVector<int> m_tileOf;     // Tile of each slot, -1 if not placed
+};
+
+#endif // TILEINDEX_H
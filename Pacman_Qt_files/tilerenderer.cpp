@@ -0,0 +1,37 @@
+#include "tilerenderer.h"
+#include <QThread>
+#include <QtMath>
+
+TileRenderer::TileRenderer()
+    : m_dpr(0.0),
+    m_fullRepaint(true)
+{
+    // The simulation has a thread of its own
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+// Reallocates the framebuffer and re-cuts the tiles for a new size
+void TileRenderer::resize(QSize size, qreal dpr)
+{
+    if (size == m_size && qFuzzyCompare(dpr, m_dpr)) return;
+    m_size = size;
+    m_dpr = dpr;
+    m_fullRepaint = true;
+
+    const QSize device(qCeil(size.width() * dpr), qCeil(size.height() * dpr));
+    m_frame = QImage(device, QImage::Format_RGB32);
+    m_frame.setDevicePixelRatio(dpr);
+
+    m_tiles.clear();
+    for (int y = 0; y < device.height(); y += RENDER_TILE_HEIGHT) {
+        for (int x = 0; x < device.width(); x += RENDER_TILE_WIDTH) {
+            Tile tile;
+            tile.device = QRect(x, y, qMin(RENDER_TILE_WIDTH, device.width() - x),
+                                qMin(RENDER_TILE_HEIGHT, device.height() - y));
+            tile.logical = QRectF(QPointF(tile.device.topLeft()) / dpr, QSizeF(tile.device.size()) / dpr)
+                               .toAlignedRect();
+            tile.dirty = true;
+            m_tiles.append(tile);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+// Framebuffer tiles, in device pixels. Wide and short, so a tile is a few
+// long runs of memory and small sprites rarely straddle many tiles.
+#define RENDER_TILE_WIDTH  256
+#define RENDER_TILE_HEIGHT 64
+
+// Software renderer that paints a framebuffer on all cores.
+//
+// The framebuffer is cut into tiles; each dirty tile gets its own QPainter
+// on a QImage that views the tile's part of the shared framebuffer memory,
+// and the tiles are painted in parallel on a private thread pool. Needs no
+// GPU, and the result is presented with a single drawImage(). The paint
+// callback runs on the worker threads, so it may only read shared state.
+class TileRenderer
+{
+public:
+    TileRenderer();
+
+    // Repaints the tiles of a 'size' framebuffer (in logical pixels at
+    // 'dpr') that meet 'dirty', calling paint(painter, tileRect) for each.
+    // The painter starts in framebuffer coordinates and is clipped to the
+    // tile; tileRect is the tile in those coordinates. Other tiles keep
+    // their last contents.
+    template<typename Paint>
+    const QImage &render(QSize size, qreal dpr, const QRegion &dirty, Paint paint)
+    {
+        resize(size, dpr);
+        for (Tile &tile : m_tiles) {
+            tile.dirty = m_fullRepaint || dirty.intersects(tile.logical);
+        }
+        m_fullRepaint = false;
+
+        uchar *const bits = m_frame.bits(); // Detaches here, not on a worker
+        const qsizetype stride = m_frame.bytesPerLine();
+        const QImage::Format format = m_frame.format();
+        QtConcurrent::blockingMap(&m_pool, m_tiles, [&](Tile &tile) {
+            if (!tile.dirty) return;
+
+            QImage view(bits + tile.device.y() * stride + tile.device.x() * 4,
+                        tile.device.width(), tile.device.height(), stride, format);
+            view.setDevicePixelRatio(dpr);
+            QPainter painter(&view);
+            painter.fillRect(QRectF(QPointF(0, 0), QSizeF(tile.device.size()) / dpr), Qt::black);
+            painter.translate(-QPointF(tile.device.topLeft()) / dpr);
+            paint(painter, tile.logical);
+        });
+        return m_frame;
+    }
+
+private:
+    struct Tile {
+        QRect device;          // In framebuffer pixels
+        QRect logical;         // The same, in logical pixels (rounded out)
+        bool dirty;
+    };
+
+    void resize(QSize size, qreal dpr);
+
+    QImage m_frame;
+    QSize m_size;
+    qreal m_dpr;
+    bool m_fullRepaint;        // Contents lost, e.g. after a resize
+    QVector<Tile> m_tiles;
+    QThreadPool m_pool;
+};
+
+#endif // TILERENDERER_H
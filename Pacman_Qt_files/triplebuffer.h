@@ -0,0 +1,55 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QAtomicInt>
+
+// Hands the latest value from one writer thread to one reader thread
+// without locks or waiting.
+//
+// The writer fills back() and publish()es it; the reader fetch()es and
+// reads front(). The third buffer sits between them, so neither side ever
+// touches a buffer the other is using and a slow reader just skips values.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_back(0),
+        m_middle(1),
+        m_front(2)
+    {
+    }
+
+    // Writer side
+    T &back() { return m_buffers[m_back]; }
+
+    // Makes back() the latest value and hands over a new back(). Returns
+    // true if that new back() holds a value the reader never fetched, so a
+    // writer can carry anything in it that must not be lost.
+    bool publish()
+    {
+        int old = m_middle.fetchAndStoreOrdered(m_back | Fresh);
+        m_back = old & IndexMask;
+        return old & Fresh;
+    }
+
+    // Reader side. Swaps in the latest value; false if nothing newer was
+    // published since the last fetch.
+    bool fetch()
+    {
+        if (!(m_middle.loadAcquire() & Fresh)) return false;
+        m_front = m_middle.fetchAndStoreOrdered(m_front) & IndexMask;
+        return true;
+    }
+    const T &front() const { return m_buffers[m_front]; }
+
+private:
+    enum { IndexMask = 0x3, Fresh = 0x4 };
+
+    T m_buffers[3];
+    int m_back;          // Writer only
+    QAtomicInt m_middle; // Index of the handover buffer, plus Fresh
+    int m_front;         // Reader only
+};
+
+#endif // TRIPLEBUFFER_H